@@ -14,12 +14,14 @@ SOURCES += main.cpp \
     executer.cpp \
     codeexecuter.cpp \
     scriptexecuter.cpp \
-	mainclass.cpp
+	mainclass.cpp \
+	daemon.cpp
 HEADERS += executer.h \
     codeexecuter.h \
     scriptexecuter.h \
 	mainclass.h \
-    global.h
+    global.h \
+	daemon.h
 INCLUDEPATH += . \
     .. \
     ../tools \
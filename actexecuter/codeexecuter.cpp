@@ -20,6 +20,7 @@
 
 #include "codeexecuter.h"
 #include "executer/codeinitializer.h"
+#include "executer/executer.h"
 #include "executer/scriptagent.h"
 #include "actionfactory.h"
 #include "actionpack.h"
@@ -40,8 +41,8 @@
 #include <QApplication>
 #include <QSettings>
 
-CodeExecuter::CodeExecuter(QObject *parent) :
-    Executer(parent),
+CodeExecuter::CodeExecuter(QObject *parent, ActionTools::ActionFactory *actionFactory) :
+    Executer(parent, actionFactory),
 	mScriptEngine(new QScriptEngine(this)),
 	mScriptAgent(new LibExecuter::ScriptAgent(mScriptEngine)),
 	mScriptEngineDebugger(new QScriptEngineDebugger(this)),
@@ -51,16 +52,9 @@ CodeExecuter::CodeExecuter(QObject *parent) :
 	connect(mScriptEngineDebugger, SIGNAL(evaluationSuspended()), this, SLOT(onEvaluationPaused()));
 	connect(mScriptAgent, SIGNAL(executionStopped()), this, SLOT(stopExecution()));
 
-    for(QString extension: mScriptEngine->availableExtensions())
-		mScriptEngine->importExtension(extension);
-
     Code::setupPrettyPrinting(*mScriptEngine);
 	
 	mScriptEngineDebugger->setAutoShowStandardWindow(false);
-	mScriptEngineDebugger->attachTo(mScriptEngine);
-	QScriptEngineAgent *debuggerAgent = mScriptEngine->agent();
-	mScriptEngine->setAgent(mScriptAgent);
-	mScriptAgent->setDebuggerAgent(debuggerAgent);
 }
 
 bool CodeExecuter::start(QIODevice *device, const QString &filename)
@@ -70,6 +64,17 @@ bool CodeExecuter::start(QIODevice *device, const QString &filename)
 	
 	QString code = device->readAll();
 	device->close();
+
+	LibExecuter::CodeInitializer::importExtensions(mScriptEngine, code);
+
+	//In release mode the script runs without the debugger and without per-statement callbacks
+	if(!isReleaseMode())
+	{
+		mScriptEngineDebugger->attachTo(mScriptEngine);
+		QScriptEngineAgent *debuggerAgent = mScriptEngine->agent();
+		mScriptEngine->setAgent(mScriptAgent);
+		mScriptAgent->setDebuggerAgent(debuggerAgent);
+	}
 	
 	mScriptAgent->setContext(LibExecuter::ScriptAgent::ActionInit);
     LibExecuter::CodeInitializer::initialize(mScriptEngine, mScriptAgent, actionFactory(), filename);
@@ -92,13 +97,20 @@ bool CodeExecuter::start(QIODevice *device, const QString &filename)
     Code::CodeTools::addClassGlobalFunctionToScriptEngine("Actiona", &LibExecuter::CodeActiona::isActExec, "isActExec", mScriptEngine);
     Code::CodeTools::addClassGlobalFunctionToScriptEngine("Actiona", &LibExecuter::CodeActiona::isActiona, "isActiona", mScriptEngine);
 
-    QString locale = Tools::locale();
-
-	for(int actionPackIndex = 0; actionPackIndex < actionFactory()->actionPackCount(); ++actionPackIndex)
+	//Translators are global to the application, install them only once when running as a daemon
+	static bool translatorsInstalled = false;
+	if(!translatorsInstalled)
 	{
-		ActionTools::ActionPack *actionPack = actionFactory()->actionPack(actionPackIndex);
+		QString locale = Tools::locale();
+
+		for(int actionPackIndex = 0; actionPackIndex < actionFactory()->actionPackCount(); ++actionPackIndex)
+		{
+			ActionTools::ActionPack *actionPack = actionFactory()->actionPack(actionPackIndex);
+
+			Tools::installTranslator(QString("actionpack%1").arg(actionPack->id()), locale);
+		}
 
-        Tools::installTranslator(QString("actionpack%1").arg(actionPack->id()), locale);
+		translatorsInstalled = true;
 	}
 
 	mScriptAgent->setContext(LibExecuter::ScriptAgent::Parameters);
@@ -106,13 +118,13 @@ bool CodeExecuter::start(QIODevice *device, const QString &filename)
 	QScriptValue result = mScriptEngine->evaluate(code, filename);
 	if(result.isError())
 	{
-		QTextStream stream(stdout);
+		QTextStream &stream = LibExecuter::Executer::standardOutput();
 		stream << QObject::tr("Uncaught exception: ") << result.toString() << "\n";
 		stream << tr("Backtrace: ") << mScriptEngine->uncaughtExceptionBacktrace().join("\n") << "\n";
 		stream.flush();
 	}
 	
-	QTimer::singleShot(0, qApp, SLOT(quit()));
+	finish(!result.isError());
 	
 	return true;
 }
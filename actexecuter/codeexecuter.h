@@ -37,7 +37,7 @@ class CodeExecuter : public Executer
     Q_OBJECT
 	
 public:
-    explicit CodeExecuter(QObject *parent = 0);
+    explicit CodeExecuter(QObject *parent = 0, ActionTools::ActionFactory *actionFactory = 0);
 	
 	bool start(QIODevice *device, const QString &filename);
 	
@@ -0,0 +1,430 @@
+/*
+	Actiona
+	Copyright (C) 2005-2017 Jonathan Mercier-Ganady
+
+	Actiona is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Actiona is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+	Contact : jmgr@jmgr.info
+*/
+
+#include "daemon.h"
+#include "scriptexecuter.h"
+#include "codeexecuter.h"
+#include "executer/executer.h"
+#include "actionfactory.h"
+
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QDataStream>
+#include <QTextStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+
+#include <iostream>
+#include <cstdio>
+
+#ifndef Q_OS_WIN
+#include <unistd.h>
+#endif
+
+namespace
+{
+	const int ConnectTimeout = 1000;
+
+	//Messages sent by the daemon to the client, prefixed by their size
+	enum MessageType
+	{
+		OutputMessage,
+		FinishedMessage
+	};
+
+	QString absoluteFilename(const QString &filename)
+	{
+		if(filename.isEmpty())
+			return filename;
+
+		return QFileInfo(filename).absoluteFilePath();
+	}
+
+	//False if the socket of this name exists and belongs to another user, who could then receive or run our jobs
+	bool isSocketOwnedByCurrentUser(const QString &name)
+	{
+#ifdef Q_OS_WIN
+		//Named pipes are removed with their server and restricted by UserAccessOption
+		Q_UNUSED(name)
+
+		return true;
+#else
+		//Same path as the one used by QLocalServer
+		QFileInfo socketFileInfo(name.startsWith('/') ? name : QDir::cleanPath(QDir::tempPath()) + '/' + name);
+
+		return (!socketFileInfo.exists() || socketFileInfo.ownerId() == getuid());
+#endif
+	}
+
+	void sendMessage(QLocalSocket *socket, MessageType type, const QByteArray &output, bool success)
+	{
+		if(!socket)
+			return;
+
+		QByteArray block;
+		{
+			QDataStream stream(&block, QIODevice::WriteOnly);
+			stream.setVersion(QDataStream::Qt_5_2);
+
+			stream << quint32(0) << qint8(type);
+
+			if(type == OutputMessage)
+				stream << output;
+			else
+				stream << success;
+
+			stream.device()->seek(0);
+			stream << quint32(block.size() - sizeof(quint32));
+		}
+
+		socket->write(block);
+	}
+
+	//Sends what a job prints to its client, instead of the daemon output
+	class JobOutput : public QIODevice
+	{
+	public:
+		explicit JobOutput(QLocalSocket *socket)
+			: mSocket(socket)
+		{
+			open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+		}
+
+	protected:
+		qint64 readData(char *data, qint64 maxSize)
+		{
+			Q_UNUSED(data)
+			Q_UNUSED(maxSize)
+
+			return -1;
+		}
+
+		qint64 writeData(const char *data, qint64 maxSize)
+		{
+			sendMessage(mSocket, OutputMessage, QByteArray(data, static_cast<int>(maxSize)), false);
+
+			return maxSize;
+		}
+
+	private:
+		QPointer<QLocalSocket> mSocket;
+	};
+}
+
+QString Daemon::defaultName()
+{
+	//One daemon per user, so that nobody else can send it jobs
+#ifdef Q_OS_WIN
+	return QString("actiona-actexec-%1").arg(QString::fromLocal8Bit(qgetenv("USERNAME")));
+#else
+	return QString("actiona-actexec-%1").arg(getuid());
+#endif
+}
+
+Daemon::Daemon(QObject *parent)
+	: QObject(parent),
+	mServer(new QLocalServer(this)),
+	mActionFactory(new ActionTools::ActionFactory(this)),
+	mCurrentExecuter(0),
+	mJobOutput(0)
+{
+	connect(mServer, SIGNAL(newConnection()), this, SLOT(newConnection()));
+	connect(mActionFactory, SIGNAL(actionPackLoadError(QString)), this, SLOT(actionPackLoadError(QString)));
+}
+
+bool Daemon::start(const QString &name)
+{
+	QTextStream stream(stdout);
+
+	if(!isSocketOwnedByCurrentUser(name))
+	{
+		stream << QObject::tr("The daemon name \"%1\" is used by another user").arg(name) << "\n";
+		stream.flush();
+		return false;
+	}
+
+	{
+		QLocalSocket socket;
+		socket.connectToServer(name);
+		if(socket.waitForConnected(ConnectTimeout))
+		{
+			stream << QObject::tr("A daemon named \"%1\" is already running").arg(name) << "\n";
+			stream.flush();
+			return false;
+		}
+	}
+
+	Executer::loadActionPacks(mActionFactory);
+
+	//Remove the socket file left by a daemon that did not exit cleanly, it belongs to the current user
+	QLocalServer::removeServer(name);
+
+	//Only the current user can connect
+	mServer->setSocketOptions(QLocalServer::UserAccessOption);
+
+	if(!mServer->listen(name))
+	{
+		stream << QObject::tr("Unable to start the daemon: %1").arg(mServer->errorString()) << "\n";
+		stream.flush();
+		return false;
+	}
+
+	stream << QObject::tr("Daemon listening as \"%1\"").arg(mServer->fullServerName()) << "\n";
+	stream.flush();
+
+	return true;
+}
+
+int Daemon::submit(const QString &name,
+				   MainClass::ExecutionMode executionMode,
+				   const QString &filename,
+				   bool releaseMode,
+				   bool trustedInput,
+				   const QString &profileFilename,
+				   const QString &traceFilename)
+{
+	QTextStream output(stdout);
+	QLocalSocket socket;
+
+	if(!isSocketOwnedByCurrentUser(name))
+	{
+		output << QObject::tr("The daemon name \"%1\" is used by another user").arg(name) << "\n";
+		output.flush();
+		return -1;
+	}
+
+	socket.connectToServer(name);
+	if(!socket.waitForConnected(ConnectTimeout))
+	{
+		output << QObject::tr("Unable to connect to the daemon: %1").arg(socket.errorString()) << "\n";
+		output.flush();
+		return -1;
+	}
+
+	//The daemon can have another working directory
+	QByteArray block;
+	{
+		QDataStream stream(&block, QIODevice::WriteOnly);
+		stream.setVersion(QDataStream::Qt_5_2);
+
+		stream << quint32(0)
+			   << qint32(executionMode)
+			   << absoluteFilename(filename)
+			   << releaseMode
+			   << trustedInput
+			   << absoluteFilename(profileFilename)
+			   << absoluteFilename(traceFilename);
+
+		stream.device()->seek(0);
+		stream << quint32(block.size() - sizeof(quint32));
+	}
+
+	socket.write(block);
+	socket.flush();
+
+	auto waitForBytes = [&](qint64 size)
+	{
+		while(socket.bytesAvailable() < size)
+		{
+			if(!socket.waitForReadyRead(-1))
+			{
+				output << QObject::tr("The daemon closed the connection: %1").arg(socket.errorString()) << "\n";
+				output.flush();
+				return false;
+			}
+		}
+
+		return true;
+	};
+
+	QDataStream stream(&socket);
+	stream.setVersion(QDataStream::Qt_5_2);
+
+	//What the job prints is received until its end, and printed as if it was executed here
+	forever
+	{
+		if(!waitForBytes(sizeof(quint32)))
+			return -1;
+
+		quint32 messageSize;
+		stream >> messageSize;
+
+		if(!waitForBytes(messageSize))
+			return -1;
+
+		qint8 messageType;
+		stream >> messageType;
+
+		switch(messageType)
+		{
+		case OutputMessage:
+			{
+				QByteArray jobOutput;
+				stream >> jobOutput;
+
+				output.flush();
+				std::fwrite(jobOutput.constData(), 1, jobOutput.size(), stdout);
+				std::fflush(stdout);
+			}
+			break;
+		case FinishedMessage:
+			{
+				bool success;
+				stream >> success;
+
+				return success ? 0 : -1;
+			}
+		default:
+			output << QObject::tr("Invalid message received from the daemon") << "\n";
+			output.flush();
+			return -1;
+		}
+	}
+}
+
+void Daemon::newConnection()
+{
+	while(QLocalSocket *socket = mServer->nextPendingConnection())
+	{
+		connect(socket, SIGNAL(readyRead()), this, SLOT(readJob()));
+		connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+	}
+}
+
+void Daemon::readJob()
+{
+	QLocalSocket *socket = qobject_cast<QLocalSocket *>(sender());
+	if(!socket)
+		return;
+
+	QDataStream stream(socket);
+	stream.setVersion(QDataStream::Qt_5_2);
+
+	//Jobs are prefixed by their size, they can arrive in several parts
+	quint32 blockSize = socket->property("blockSize").toUInt();
+	if(blockSize == 0)
+	{
+		if(socket->bytesAvailable() < static_cast<qint64>(sizeof(quint32)))
+			return;
+
+		stream >> blockSize;
+		socket->setProperty("blockSize", blockSize);
+	}
+
+	if(socket->bytesAvailable() < static_cast<qint64>(blockSize))
+		return;
+
+	socket->setProperty("blockSize", 0);
+
+	Job job;
+	qint32 executionMode;
+
+	stream >> executionMode >> job.filename >> job.releaseMode >> job.trustedInput >> job.profileFilename >> job.traceFilename;
+
+	job.socket = socket;
+	job.executionMode = executionMode;
+
+	mJobs.enqueue(job);
+
+	if(!mCurrentExecuter)
+		startNextJob();
+}
+
+void Daemon::jobFinished(bool success)
+{
+	reply(mCurrentSocket, success);
+
+	mCurrentExecuter->deleteLater();
+	mCurrentExecuter = 0;
+	mCurrentSocket = 0;
+
+	startNextJob();
+}
+
+void Daemon::actionPackLoadError(const QString &error)
+{
+	std::wcerr << error.toStdWString() << std::endl;
+}
+
+void Daemon::startNextJob()
+{
+	while(!mJobs.isEmpty())
+	{
+		Job job = mJobs.dequeue();
+
+		//The client is gone
+		if(!job.socket)
+			continue;
+
+		mJobOutput = new JobOutput(job.socket);
+		LibExecuter::Executer::setStandardOutput(mJobOutput);
+
+		QFile file(job.filename);
+		if(!file.open(QIODevice::ReadOnly))
+		{
+			QTextStream &stream = LibExecuter::Executer::standardOutput();
+			stream << QObject::tr("Unable to read input file") << " \"" << job.filename << "\"\n";
+			stream.flush();
+
+			reply(job.socket, false);
+			continue;
+		}
+
+		Executer *executer;
+		if(job.executionMode == MainClass::Script)
+			executer = new ScriptExecuter(this, mActionFactory);
+		else
+			executer = new CodeExecuter(this, mActionFactory);
+
+		executer->setReleaseMode(job.releaseMode);
+		executer->setTrustedInput(job.trustedInput);
+		executer->setProfileFilename(job.profileFilename);
+		executer->setTraceFilename(job.traceFilename);
+
+		connect(executer, SIGNAL(finished(bool)), this, SLOT(jobFinished(bool)));
+
+		mCurrentExecuter = executer;
+		mCurrentSocket = job.socket;
+
+		if(executer->start(&file, file.fileName()))
+			return;
+
+		mCurrentExecuter = 0;
+		mCurrentSocket = 0;
+		executer->deleteLater();
+
+		reply(job.socket, false);
+	}
+}
+
+void Daemon::reply(QLocalSocket *socket, bool success)
+{
+	//Send what remains of the job output before its result
+	LibExecuter::Executer::setStandardOutput(0);
+	delete mJobOutput;
+	mJobOutput = 0;
+
+	if(!socket)
+		return;
+
+	sendMessage(socket, FinishedMessage, QByteArray(), success);
+	socket->flush();
+}
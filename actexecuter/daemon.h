@@ -0,0 +1,91 @@
+/*
+	Actiona
+	Copyright (C) 2005-2017 Jonathan Mercier-Ganady
+
+	Actiona is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Actiona is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+	Contact : jmgr@jmgr.info
+*/
+
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include "mainclass.h"
+
+#include <QObject>
+#include <QQueue>
+#include <QPointer>
+
+class Executer;
+class QLocalServer;
+class QLocalSocket;
+class QIODevice;
+
+namespace ActionTools
+{
+	class ActionFactory;
+}
+
+//Keeps the action packs loaded and executes the jobs sent by other actexec instances, one at a time
+class Daemon : public QObject
+{
+	Q_OBJECT
+
+public:
+	//Name of the daemon of the current user
+	static QString defaultName();
+
+	explicit Daemon(QObject *parent = 0);
+
+	bool start(const QString &name);
+
+	//Sends a job to a running daemon, prints its output and waits for its end, returns the process exit code
+	static int submit(const QString &name,
+					  MainClass::ExecutionMode executionMode,
+					  const QString &filename,
+					  bool releaseMode,
+					  bool trustedInput,
+					  const QString &profileFilename,
+					  const QString &traceFilename);
+
+private slots:
+	void newConnection();
+	void readJob();
+	void jobFinished(bool success);
+	void actionPackLoadError(const QString &error);
+
+private:
+	struct Job
+	{
+		QPointer<QLocalSocket> socket;
+		int executionMode;
+		QString filename;
+		bool releaseMode;
+		bool trustedInput;
+		QString profileFilename;
+		QString traceFilename;
+	};
+
+	void startNextJob();
+	void reply(QLocalSocket *socket, bool success);
+
+	QLocalServer *mServer;
+	ActionTools::ActionFactory *mActionFactory;
+	QQueue<Job> mJobs;
+	Executer *mCurrentExecuter;
+	QPointer<QLocalSocket> mCurrentSocket;
+	QIODevice *mJobOutput;
+};
+
+#endif // DAEMON_H
@@ -27,10 +27,12 @@
 #include <QSettings>
 #include <QLocale>
 
-Executer::Executer(QObject *parent) :
+Executer::Executer(QObject *parent, ActionTools::ActionFactory *actionFactory) :
 	QObject(parent),
-	mActionFactory(new ActionTools::ActionFactory(this)),
-	mActionLoadingFailed(false)
+	mActionFactory(actionFactory ? actionFactory : new ActionTools::ActionFactory(this)),
+	mActionLoadingFailed(false),
+	mReleaseMode(false),
+	mTrustedInput(false)
 {
 	connect(mActionFactory, SIGNAL(actionPackLoadError(QString)), this, SLOT(actionPackLoadError(QString)));
 }
@@ -44,14 +46,8 @@ bool Executer::start(QIODevice *device, const QString &filename)
 	Q_UNUSED(device)
 	Q_UNUSED(filename)
 
-	QSettings settings;
-    QString locale = settings.value("gui/locale", QLocale::system().name()).toString();
-
-	mActionFactory->loadActionPacks(QApplication::applicationDirPath() + "/actions/", locale);
-#ifndef Q_OS_WIN
 	if(mActionFactory->actionPackCount() == 0)
-        mActionFactory->loadActionPacks(QString("%1/%2/actiona/actions/").arg(ACT_PREFIX).arg(ACT_LIBDIR), locale);
-#endif
+		loadActionPacks(mActionFactory);
 
 	if(mActionLoadingFailed)
 		return false;
@@ -59,6 +55,23 @@ bool Executer::start(QIODevice *device, const QString &filename)
 	return true;
 }
 
+void Executer::loadActionPacks(ActionTools::ActionFactory *actionFactory)
+{
+	QSettings settings;
+    QString locale = settings.value("gui/locale", QLocale::system().name()).toString();
+
+	actionFactory->loadActionPacks(QApplication::applicationDirPath() + "/actions/", locale);
+#ifndef Q_OS_WIN
+	if(actionFactory->actionPackCount() == 0)
+        actionFactory->loadActionPacks(QString("%1/%2/actiona/actions/").arg(ACT_PREFIX).arg(ACT_LIBDIR), locale);
+#endif
+}
+
+void Executer::finish(bool success)
+{
+	QMetaObject::invokeMethod(this, "finished", Qt::QueuedConnection, Q_ARG(bool, success));
+}
+
 ActionTools::ActionFactory *Executer::actionFactory() const
 {
 	return mActionFactory;
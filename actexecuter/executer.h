@@ -35,13 +35,31 @@ class Executer : public QObject
     Q_OBJECT
 	
 public:
-    explicit Executer(QObject *parent = 0);
+    //The action factory can be shared between executers, its action packs are then only loaded once
+    explicit Executer(QObject *parent = 0, ActionTools::ActionFactory *actionFactory = 0);
 	virtual ~Executer();
 	
 	virtual bool start(QIODevice *device, const QString &filename);
+
+	static void loadActionPacks(ActionTools::ActionFactory *actionFactory);
+
+	void setReleaseMode(bool releaseMode)				{ mReleaseMode = releaseMode; }
+	void setTrustedInput(bool trustedInput)				{ mTrustedInput = trustedInput; }
+	void setProfileFilename(const QString &profileFilename)	{ mProfileFilename = profileFilename; }
+	void setTraceFilename(const QString &traceFilename)	{ mTraceFilename = traceFilename; }
 	
 protected:
 	ActionTools::ActionFactory *actionFactory() const;
+	bool isReleaseMode() const							{ return mReleaseMode; }
+	bool isTrustedInput() const							{ return mTrustedInput; }
+	const QString &profileFilename() const				{ return mProfileFilename; }
+	const QString &traceFilename() const				{ return mTraceFilename; }
+
+	//Emits finished once control returns to the event loop
+	void finish(bool success);
+
+signals:
+	void finished(bool success);
 
 private slots:
 	void actionPackLoadError(const QString &error);
@@ -49,6 +67,10 @@ private slots:
 private:
 	ActionTools::ActionFactory *mActionFactory;
 	bool mActionLoadingFailed;
+	bool mReleaseMode;
+	bool mTrustedInput;
+	QString mProfileFilename;
+	QString mTraceFilename;
 };
 
 #endif // EXECUTER_H
@@ -23,6 +23,11 @@
 #include "actioninstance.h"
 #include "version.h"
 #include "mainclass.h"
+#include "executer/executiontrace.h"
+#include "daemon.h"
+#include "executer.h"
+#include "script.h"
+#include "actionfactory.h"
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
 #include "qtsingleapplication/qtsingleapplication.h"
 #else
@@ -100,6 +105,55 @@ static void createConsole()
 
 #endif
 
+//Writes a script in the binary format, that can then be executed without XML parsing
+static int compileScript(const QString &filename, const QString &outputFilename, bool trustedInput)
+{
+	QTextStream stream(stdout);
+	ActionTools::ActionFactory actionFactory;
+	ActionTools::Script script(&actionFactory);
+
+	Executer::loadActionPacks(&actionFactory);
+
+	QFile file(filename);
+	if(!file.open(QIODevice::ReadOnly))
+	{
+		stream << QObject::tr("Unable to read input file") << "\n";
+		stream.flush();
+		return -1;
+	}
+
+	ActionTools::Script::ReadResult result = (ActionTools::Script::isBinaryScript(&file) ?
+												  script.readBinary(&file, Global::SCRIPT_VERSION) :
+												  script.read(&file, Global::SCRIPT_VERSION, trustedInput));
+	if(result != ActionTools::Script::ReadSuccess)
+	{
+		stream << QObject::tr("Unable to read the script file") << "\n";
+		stream.flush();
+		return -1;
+	}
+
+	//Actions that cannot be loaded would be missing from the compiled script
+	if(!script.missingActions().isEmpty())
+	{
+		stream << QObject::tr("The script uses unknown actions: %1").arg(script.missingActions().join(", ")) << "\n";
+		stream.flush();
+		return -1;
+	}
+
+	//The output file could be the input one
+	script.loadResources();
+
+	QFile outputFile(outputFilename);
+	if(!outputFile.open(QIODevice::WriteOnly) || !script.writeBinary(&outputFile, Global::ACTIONA_VERSION, Global::SCRIPT_VERSION))
+	{
+		stream << QObject::tr("Unable to write the compiled script file") << "\n";
+		stream.flush();
+		return -1;
+	}
+
+	return 0;
+}
+
 int main(int argc, char **argv)
 {
 #if (QT_VERSION < 0x050200)
@@ -159,6 +213,16 @@ int main(int argc, char **argv)
     options.alias("nocodeqt", "Q");
     options.add("portable", QObject::tr("starts in portable mode, storing the settings in the executable folder"));
     options.alias("portable", "p");
+    options.add("release", QObject::tr("execute without the script debugger, faster but code errors only report their line"));
+    options.alias("release", "r");
+    options.add("trusted", QObject::tr("do not validate the script file against the schema, for generated scripts"));
+    options.add("compile", QObject::tr("write the script in the binary format (.ascb) to a file instead of executing it"), QxtCommandOptions::ValueRequired);
+    options.add("profile", QObject::tr("write per-action execution timings to a file, in CSV if its name ends with .csv, in JSON otherwise"), QxtCommandOptions::ValueRequired);
+    options.add("trace", QObject::tr("write the last execution events to a file if the script stops on an error"), QxtCommandOptions::ValueRequired);
+    options.add("decode-trace", QObject::tr("print the execution events contained in a trace file"));
+    options.add("daemon", QObject::tr("keep the action packs loaded and execute the files sent with --client, one at a time"));
+    options.add("client", QObject::tr("send the file to a running daemon and wait for the end of its execution"));
+    options.add("daemon-name", QObject::tr("name of the daemon to start or to connect to"), QxtCommandOptions::ValueRequired);
     options.add("proxy-mode", QObject::tr("sets the proxy mode, values are \"none\", \"system\" (default) or \"custom\""));
     options.add("proxy-type", QObject::tr("sets the custom proxy type, values are \"http\" or \"socks\" (default)"));
     options.add("proxy-host", QObject::tr("sets the custom proxy host"));
@@ -203,7 +267,7 @@ int main(int argc, char **argv)
 		stream.flush();
 		return 0;
 	}
-	if(options.count("help") || options.showUnrecognizedWarning() || options.positional().count() < 1 || (options.count("code") && options.count("script")))
+	if(options.count("help") || options.showUnrecognizedWarning() || (options.positional().count() < 1 && !options.count("daemon")) || (options.count("code") && options.count("script")))
 	{
 		QTextStream stream(stdout);
 		stream << QObject::tr("usage: ") << QCoreApplication::arguments().at(0) << " " << QObject::tr("[parameters]") << " " << QObject::tr("filename") << "\n";
@@ -213,6 +277,28 @@ int main(int argc, char **argv)
 		return -1;
 	}
 
+	if(options.count("decode-trace"))
+	{
+		QTextStream stream(stdout);
+		QFile file(options.positional().at(0));
+		if(!file.open(QIODevice::ReadOnly))
+		{
+			stream << QObject::tr("Unable to read input file") << "\n";
+			stream.flush();
+			return -1;
+		}
+
+		if(!LibExecuter::ExecutionTrace::decode(&file, stream))
+		{
+			stream << QObject::tr("Invalid trace file") << "\n";
+			stream.flush();
+			return -1;
+		}
+
+		stream.flush();
+		return 0;
+	}
+
 	app.addLibraryPath(QApplication::applicationDirPath() + "/actions");
 	app.addLibraryPath(QApplication::applicationDirPath() + "/plugins");
 
@@ -294,6 +380,19 @@ int main(int argc, char **argv)
 
 	QNetworkProxy::setApplicationProxy(proxy);
 
+	QString daemonName = options.value("daemon-name").toString();
+	if(daemonName.isEmpty())
+		daemonName = Daemon::defaultName();
+
+	if(options.count("daemon"))
+	{
+		Daemon daemon;
+		if(!daemon.start(daemonName))
+			return -1;
+
+		return app.exec();
+	}
+
 	QUrl protocolUrl = QUrl::fromEncoded(arguments.at(1).toUtf8());
     if(protocolUrl.isValid() && protocolUrl.scheme() != "actiona")
 		protocolUrl = QUrl();
@@ -301,6 +400,11 @@ int main(int argc, char **argv)
 	MainClass::ExecutionMode executionMode = MainClass::Unknown;
 	MainClass mainClass;
 
+	mainClass.setReleaseMode(options.count("release") > 0);
+	mainClass.setTrustedInput(options.count("trusted") > 0);
+	mainClass.setProfileFilename(options.value("profile").toString());
+	mainClass.setTraceFilename(options.value("trace").toString());
+
 	if(protocolUrl.isValid())
 	{
 		QString mode;
@@ -324,7 +428,7 @@ int main(int argc, char **argv)
 			executionMode = MainClass::Script;
 		else
 		{
-			if(protocolUrl.path().endsWith(".ascr"))
+			if(protocolUrl.path().endsWith(".ascr") || protocolUrl.path().endsWith(".ascb"))
 				executionMode = MainClass::Script;
 			else if(protocolUrl.path().endsWith(".acod"))
 				executionMode = MainClass::Code;
@@ -350,7 +454,7 @@ int main(int argc, char **argv)
 			executionMode = MainClass::Script;
 		else
 		{
-			if(filename.endsWith(".ascr"))
+			if(filename.endsWith(".ascr") || filename.endsWith(".ascb"))
 				executionMode = MainClass::Script;
 			else if(filename.endsWith(".acod"))
 				executionMode = MainClass::Code;
@@ -363,6 +467,28 @@ int main(int argc, char **argv)
 			}
 		}
 
+		if(options.count("compile"))
+		{
+			if(executionMode != MainClass::Script)
+			{
+				QTextStream stream(stdout);
+				stream << QObject::tr("Only scripts can be compiled") << "\n";
+				stream.flush();
+				return -1;
+			}
+
+			return compileScript(filename, options.value("compile").toString(), options.count("trusted") > 0);
+		}
+
+		if(options.count("client"))
+			return Daemon::submit(daemonName,
+								  executionMode,
+								  filename,
+								  options.count("release") > 0,
+								  options.count("trusted") > 0,
+								  options.value("profile").toString(),
+								  options.value("trace").toString());
+
 		QFile file(filename);
 		if(!file.open(QIODevice::ReadOnly))
 		{
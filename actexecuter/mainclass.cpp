@@ -32,7 +32,9 @@
 MainClass::MainClass()
 	: QObject(0),
 	mExecuter(0),
-	mNetworkAccessManager(new QNetworkAccessManager(this))
+	mNetworkAccessManager(new QNetworkAccessManager(this)),
+	mReleaseMode(false),
+	mTrustedInput(false)
 {
 }
 
@@ -43,6 +45,13 @@ bool MainClass::start(ExecutionMode executionMode, QIODevice *device, const QStr
 	else
 		mExecuter = new CodeExecuter(this);
 
+	connect(mExecuter, SIGNAL(finished(bool)), qApp, SLOT(quit()));
+
+	mExecuter->setReleaseMode(mReleaseMode);
+	mExecuter->setTrustedInput(mTrustedInput);
+	mExecuter->setProfileFilename(mProfileFilename);
+	mExecuter->setTraceFilename(mTraceFilename);
+
 	return mExecuter->start(device, filename);
 }
 
@@ -45,6 +45,11 @@ public:
 	};
 	
 	MainClass();
+
+	void setReleaseMode(bool releaseMode)							{ mReleaseMode = releaseMode; }
+	void setTrustedInput(bool trustedInput)							{ mTrustedInput = trustedInput; }
+	void setProfileFilename(const QString &profileFilename)			{ mProfileFilename = profileFilename; }
+	void setTraceFilename(const QString &traceFilename)				{ mTraceFilename = traceFilename; }
 	
 	bool start(ExecutionMode executionMode, QIODevice *device, const QString &filename);
 	bool start(ExecutionMode executionMode, const QUrl &url);
@@ -58,6 +63,10 @@ private:
 	QNetworkReply *mNetworkReply;
 	ExecutionMode mExecutionMode;
 	QUrl mUrl;
+	bool mReleaseMode;
+	bool mTrustedInput;
+	QString mProfileFilename;
+	QString mTraceFilename;
 };
 
 #endif // MAINCLASS_H
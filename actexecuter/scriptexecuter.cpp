@@ -21,14 +21,15 @@
 #include "scriptexecuter.h"
 #include "script.h"
 #include "executer/executer.h"
+#include "executer/executionprofiler.h"
 #include "mainclass.h"
 #include "global.h"
 
 #include <QFile>
 #include <QApplication>
 
-ScriptExecuter::ScriptExecuter(QObject *parent) :
-    Executer(parent),
+ScriptExecuter::ScriptExecuter(QObject *parent, ActionTools::ActionFactory *actionFactory) :
+    Executer(parent, actionFactory),
 	mScript(new ActionTools::Script(actionFactory(), this)),
 	mExecuter(new LibExecuter::Executer(this))
 {
@@ -41,26 +42,32 @@ bool ScriptExecuter::start(QIODevice *device, const QString &filename)
 	if(!Executer::start(device, filename))
 		return false;
 	
-	ActionTools::Script::ReadResult result = mScript->read(device, Global::SCRIPT_VERSION);
+	ActionTools::Script::ReadResult result;
+	if(ActionTools::Script::isBinaryScript(device))
+		result = mScript->readBinary(device, Global::SCRIPT_VERSION);
+	else
+		result = mScript->read(device, Global::SCRIPT_VERSION, isTrustedInput());
 	switch(result)
 	{
 	case ActionTools::Script::ReadInternal:
 		{
-			QTextStream stream(stdout);
+			QTextStream &stream = LibExecuter::Executer::standardOutput();
 			stream << QObject::tr("Reading script file failed due to an internal error") << "\n";
 			stream.flush();
 		}
 		return false;
     case ActionTools::Script::ReadInvalidSchema:
 		{
-			QTextStream stream(stdout);
+			QTextStream &stream = LibExecuter::Executer::standardOutput();
             stream << QObject::tr("Input script file has an invalid script schema") << "\n";
+			if(!mScript->statusMessage().isEmpty())
+				stream << QObject::tr("Line %1, column %2: %3").arg(mScript->line()).arg(mScript->column()).arg(mScript->statusMessage()) << "\n";
 			stream.flush();
 		}
 		return false;
     case ActionTools::Script::ReadInvalidScriptVersion:
 		{
-			QTextStream stream(stdout);
+			QTextStream &stream = LibExecuter::Executer::standardOutput();
 			stream << QObject::tr("Input script file is too recent") << "\n";
 			stream.flush();
 		}
@@ -71,10 +78,13 @@ bool ScriptExecuter::start(QIODevice *device, const QString &filename)
 	
 	device->close();
 	
+	mExecuter->setReleaseMode(isReleaseMode());
+	mExecuter->setProfilingEnabled(!profileFilename().isEmpty());
+	mExecuter->setTraceDumpFilename(traceFilename());
     mExecuter->setup(mScript, actionFactory(), false, 0, 0, false, 0, 0, mScript->pauseBefore(), mScript->pauseAfter(), Global::ACTIONA_VERSION, Global::SCRIPT_VERSION, true, 0);
     if(!mExecuter->startExecution(false, filename))
 	{
-		QTextStream stream(stdout);
+		QTextStream &stream = LibExecuter::Executer::standardOutput();
 		stream << QObject::tr("Start execution failed") << "\n";
 		stream.flush();
 		return false;
@@ -85,7 +95,14 @@ bool ScriptExecuter::start(QIODevice *device, const QString &filename)
 
 void ScriptExecuter::executionStopped()
 {
-	QApplication::quit();
+	if(mExecuter->profiler() && !mExecuter->profiler()->write(profileFilename(), mScript))
+	{
+		QTextStream &stream = LibExecuter::Executer::standardOutput();
+		stream << QObject::tr("Unable to write the profiling report to \"%1\"").arg(profileFilename()) << "\n";
+		stream.flush();
+	}
+
+	finish(!mExecuter->hasExecutionFailed());
 }
 
 void ScriptExecuter::scriptError(int actionIndex, const QString &parameter, const QString &error)
@@ -93,9 +110,9 @@ void ScriptExecuter::scriptError(int actionIndex, const QString &parameter, cons
 	Q_UNUSED(actionIndex)
 	Q_UNUSED(parameter)
 	
-	QTextStream stream(stdout);
+	QTextStream &stream = LibExecuter::Executer::standardOutput();
 	stream << QObject::tr("Execution error: ") << error << "\n";
 	stream.flush();
 	
-	QApplication::quit();
+	finish(false);
 }
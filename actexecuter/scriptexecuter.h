@@ -38,7 +38,7 @@ class ScriptExecuter : public Executer
     Q_OBJECT
 	
 public:
-    explicit ScriptExecuter(QObject *parent = 0);
+    explicit ScriptExecuter(QObject *parent = 0, ActionTools::ActionFactory *actionFactory = 0);
 	
 	bool start(QIODevice *device, const QString &filename);
 
@@ -24,6 +24,9 @@ message(** No updater will be built **)
 contains(DEFINES, ACT_PROFILE){
 message(** Profiling activated **)
 }
+contains(DEFINES, ACT_BENCHMARK){
+message(** Benchmark will be built **)
+}
 
 unix:QMAKE_CLEAN += actions/*.so
 win32:QMAKE_CLEAN += actions/*.dll
@@ -60,3 +63,13 @@ SUBDIRS += tools \
 	actions/actionpackdevice \
 	actions/actionpacksystem \
 	actions/actionpackdata
+
+contains(DEFINES, ACT_BENCHMARK){
+SUBDIRS += benchmark
+
+benchmark_run.target = run-benchmark
+benchmark_run.depends = sub-benchmark
+unix:benchmark_run.commands = QT_QPA_PLATFORM=offscreen ./actbench
+win32:benchmark_run.commands = actbench.exe
+QMAKE_EXTRA_TARGETS += benchmark_run
+}
@@ -52,6 +52,7 @@ namespace Actions
 			if(!mInitialized)
 			{
 				mInitialized = true;
+				setResetNeeded();
 
 				count = evaluateInteger(ok, "count");
 
@@ -32,6 +32,7 @@
 #include "windowparameterdefinition.h"
 #include "booleanparameterdefinition.h"
 #include "ifactionparameterdefinition.h"
+#include "positionparameterdefinition.h"
 
 #include <limits>
 
@@ -150,6 +151,19 @@ namespace Actions
             searchDelay->setSuffix(tr(" ms", "milliseconds"));
             addElement(searchDelay, 1);
 
+            ActionTools::PositionParameterDefinition *searchAreaTopLeft = new ActionTools::PositionParameterDefinition(ActionTools::Name("searchAreaTopLeft", tr("Search area top left corner")), this);
+            searchAreaTopLeft->setTooltip(tr("The top left corner of the area to search in\nLeave both corners empty to search in the whole source"));
+            addElement(searchAreaTopLeft, 1);
+
+            ActionTools::PositionParameterDefinition *searchAreaBottomRight = new ActionTools::PositionParameterDefinition(ActionTools::Name("searchAreaBottomRight", tr("Search area bottom right corner")), this);
+            searchAreaBottomRight->setTooltip(tr("The bottom right corner of the area to search in\nLeave both corners empty to search in the whole source"));
+            addElement(searchAreaBottomRight, 1);
+
+            ActionTools::BooleanParameterDefinition *searchNearLastMatch = new ActionTools::BooleanParameterDefinition(ActionTools::Name("searchNearLastMatch", tr("Search near the last match first")), this);
+            searchNearLastMatch->setTooltip(tr("Search around the position where the image was last found before searching everywhere\nOnly used when searching for one image"));
+            searchNearLastMatch->setDefaultValue(false);
+            addElement(searchNearLastMatch, 1);
+
             ActionTools::VariableParameterDefinition *confidence = new ActionTools::VariableParameterDefinition(ActionTools::Name("confidence", tr("Confidence")), this);
             confidence->setTooltip(tr("The name of the variable where to store the confidence value found image"));
             addElement(confidence, 1);
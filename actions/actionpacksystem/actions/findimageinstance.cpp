@@ -51,7 +51,12 @@ namespace Actions
           mSource(ScreenshotSource),
           mMaximumMatches(1),
           mDownPyramidCount(0),
-          mSearchExpansion(0)
+          mSearchExpansion(0),
+          mSearchNearLastMatch(false),
+          mSearchingNearLastMatch(false),
+          mHasLastMatch(false),
+          mLastMatchImageKey(0),
+          mLastMatchImageIndex(0)
 	{
 		connect(mOpenCVAlgorithms, SIGNAL(finished(ActionTools::MatchingPointList)), this, SLOT(searchFinished(ActionTools::MatchingPointList)));
         connect(&mWaitTimer, SIGNAL(timeout()), this, SLOT(startSearching()));
@@ -81,9 +86,25 @@ namespace Actions
         mConfidenceVariableName = evaluateVariable(ok, "confidence");
         mSearchDelay = evaluateInteger(ok, "searchDelay");
 
+        bool isSearchAreaTopLeftEmpty;
+        bool isSearchAreaBottomRightEmpty;
+        QPoint searchAreaTopLeft = evaluatePoint(ok, "searchAreaTopLeft", "value", &isSearchAreaTopLeftEmpty);
+        QPoint searchAreaBottomRight = evaluatePoint(ok, "searchAreaBottomRight", "value", &isSearchAreaBottomRightEmpty);
+        mSearchNearLastMatch = evaluateBoolean(ok, "searchNearLastMatch");
+
 		if(!ok)
 			return;
 
+        // the whole source is searched unless both corners are set
+        if(isSearchAreaTopLeftEmpty || isSearchAreaBottomRightEmpty)
+            mSearchArea = QRect();
+        else
+            mSearchArea = QRect(searchAreaTopLeft, searchAreaBottomRight).normalized();
+
+        // another image to find makes the last match meaningless
+        if(mImageToFind.cacheKey() != mLastMatchImageKey)
+            mHasLastMatch = false;
+
         validateParameterRange(ok, mConfidenceMinimum, "confidenceMinimum", tr("minimum confidence"), 0, 100);
 		validateParameterRange(ok, mMaximumMatches, "maximumMatches", tr("maximum matches"), 1);
 		validateParameterRange(ok, mDownPyramidCount, "downPyramidCount", tr("downsampling"), 1);
@@ -114,6 +135,7 @@ namespace Actions
         mOpenCVAlgorithms->cancelSearch();
 
         mImagesToSearchIn.clear();
+        mSearchingNearLastMatch = false;
 
         switch(mSource)
         {
@@ -162,12 +184,71 @@ namespace Actions
             break;
         }
 
+        // the target usually reappears where it was, so only a neighbourhood of the last match is searched first,
+        //  the full search is done if it is not found there
+        if(mSearchNearLastMatch && mMaximumMatches == 1 && mHasLastMatch && mLastMatchImageIndex < mImagesToSearchIn.size())
+        {
+            QRect neighbourhood(QPoint(), mImageToFind.size() * 3);
+            neighbourhood.moveCenter(mLastMatchPosition);
+
+            mSearchingNearLastMatch = startSearchingIn(QList<int>() << mLastMatchImageIndex, neighbourhood);
+            if(mSearchingNearLastMatch)
+                return;
+        }
+
+        startFullSearch();
+    }
+
+    void FindImageInstance::startFullSearch()
+    {
+        QList<int> imageIndexes;
+        imageIndexes.reserve(mImagesToSearchIn.size());
+
+        for(int imageIndex = 0; imageIndex < mImagesToSearchIn.size(); ++imageIndex)
+            imageIndexes.append(imageIndex);
+
+        // no image is large enough once restricted to the search area
+        if(!startSearchingIn(imageIndexes, QRect()))
+            searchFinished(ActionTools::MatchingPointList());
+    }
+
+    bool FindImageInstance::startSearchingIn(const QList<int> &imageIndexes, const QRect &area)
+    {
         QList<QImage> sourceImages;
-        sourceImages.reserve(mImagesToSearchIn.size());
+        sourceImages.reserve(imageIndexes.size());
+
+        mSearchedImages.clear();
+
+        for(int imageIndex: imageIndexes)
+        {
+            const QPair<QPixmap, QRect> &imageToSearchIn = mImagesToSearchIn.at(imageIndex);
+            QRect imageRect(QPoint(), imageToSearchIn.first.size());
+            QRect searchedRect = imageRect;
+
+            // the search area is in the coordinates of the returned positions
+            if(!mSearchArea.isNull())
+            {
+                QPoint offset = (mSource != WindowSource || !mWindowRelativePosition) ? imageToSearchIn.second.topLeft() : QPoint();
+
+                searchedRect &= mSearchArea.translated(-offset);
+            }
 
-        using PixmapRectPair = QPair<QPixmap, QRect>;
-        for(const PixmapRectPair &imageToSearchIn: mImagesToSearchIn)
-            sourceImages.append(imageToSearchIn.first.toImage());
+            if(!area.isNull())
+                searchedRect &= area;
+
+            if(searchedRect.width() < mImageToFind.width() || searchedRect.height() < mImageToFind.height())
+                continue;
+
+            if(searchedRect == imageRect)
+                sourceImages.append(imageToSearchIn.first.toImage());
+            else
+                sourceImages.append(imageToSearchIn.first.copy(searchedRect).toImage());
+
+            mSearchedImages.append(qMakePair(imageIndex, searchedRect.topLeft()));
+        }
+
+        if(sourceImages.isEmpty())
+            return false;
 
         if(!mOpenCVAlgorithms->findSubImageAsync(sourceImages,
                                                  mImageToFind,
@@ -178,15 +259,40 @@ namespace Actions
                                                  static_cast<ActionTools::OpenCVAlgorithms::AlgorithmMethod>(mMethod)))
         {
             emit executionException(ErrorWhileSearchingException, tr("Error while searching: %1").arg(mOpenCVAlgorithms->errorString()));
-
-            return;
         }
+
+        return true;
     }
 
-	void FindImageInstance::searchFinished(const ActionTools::MatchingPointList &matchingPointList)
+	void FindImageInstance::searchFinished(const ActionTools::MatchingPointList &searchedMatchingPointList)
 	{
         bool ok = true;
 
+        // back to the coordinates of the images to search in
+        ActionTools::MatchingPointList matchingPointList = searchedMatchingPointList;
+        for(ActionTools::MatchingPoint &matchingPoint: matchingPointList)
+        {
+            const QPair<int, QPoint> &searchedImage = mSearchedImages.at(matchingPoint.imageIndex);
+
+            matchingPoint.imageIndex = searchedImage.first;
+            matchingPoint.position += searchedImage.second;
+        }
+
+        if(mSearchingNearLastMatch)
+        {
+            mSearchingNearLastMatch = false;
+
+            if(matchingPointList.empty())
+            {
+                // the watcher is connected again by the next search
+                mOpenCVAlgorithms->cancelSearch();
+
+                startFullSearch();
+
+                return;
+            }
+        }
+
         if(matchingPointList.empty())
         {
             setCurrentParameter("ifNotFound", "line");
@@ -223,6 +329,11 @@ namespace Actions
             const ActionTools::MatchingPoint &bestMatchingPoint = matchingPointList.first();
             QPoint position = bestMatchingPoint.position;
 
+            mHasLastMatch = true;
+            mLastMatchImageKey = mImageToFind.cacheKey();
+            mLastMatchImageIndex = bestMatchingPoint.imageIndex;
+            mLastMatchPosition = position;
+
             if(mSource != WindowSource || !mWindowRelativePosition)
                 position += mImagesToSearchIn.at(bestMatchingPoint.imageIndex).second.topLeft();
 
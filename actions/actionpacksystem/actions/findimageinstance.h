@@ -73,9 +73,12 @@ namespace Actions
 
 	private slots:
         void startSearching();
-		void searchFinished(const ActionTools::MatchingPointList &matchingPointList);
+		void searchFinished(const ActionTools::MatchingPointList &searchedMatchingPointList);
 
 	private:
+        void startFullSearch();
+        bool startSearchingIn(const QList<int> &imageIndexes, const QRect &area);
+
 		ActionTools::OpenCVAlgorithms *mOpenCVAlgorithms;
 		QString mPositionVariableName;
         QString mConfidenceVariableName;
@@ -92,7 +95,17 @@ namespace Actions
         int mDownPyramidCount;
         int mSearchExpansion;
         int mSearchDelay;
+        QRect mSearchArea;
+        bool mSearchNearLastMatch;
         QTimer mWaitTimer;
+        // index in mImagesToSearchIn and position in that image of the part given to the search
+        QList< QPair<int, QPoint> > mSearchedImages;
+        bool mSearchingNearLastMatch;
+        // the last match is kept between executions, as long as the image to find is the same
+        bool mHasLastMatch;
+        qint64 mLastMatchImageKey;
+        int mLastMatchImageIndex;
+        QPoint mLastMatchPosition;
 
 		Q_DISABLE_COPY(FindImageInstance)
 	};
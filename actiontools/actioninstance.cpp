@@ -28,11 +28,14 @@
 #include "code/point.h"
 #include "code/color.h"
 #include "code/image.h"
+#include "imagecache.h"
 
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QScriptValueIterator>
 #include <QApplication>
 #include <QDesktopWidget>
+#include <QPolygon>
 
 namespace ActionTools
 {
@@ -56,10 +59,38 @@ namespace ActionTools
     const QRegExp ActionInstance::NameRegExp("^[A-Za-z_][A-Za-z0-9_]*$", Qt::CaseSensitive, QRegExp::RegExp2);
     const QRegExp ActionInstance::VariableRegExp("\\$([A-Za-z_][A-Za-z0-9_]*)", Qt::CaseSensitive, QRegExp::RegExp2);
 	qint64 ActionInstance::mCurrentRuntimeId = 0;
+	bool ActionInstance::mProfilingEnabled = false;
+
+	namespace
+	{
+		//Adds the time spent in the current scope to a counter, if any
+		class EvaluationTimer
+		{
+		public:
+			explicit EvaluationTimer(qint64 *evaluationTime)
+				: mEvaluationTime(evaluationTime)
+			{
+				if(mEvaluationTime)
+					mTimer.start();
+			}
+			~EvaluationTimer()
+			{
+				if(mEvaluationTime)
+					*mEvaluationTime += mTimer.nsecsElapsed();
+			}
+
+		private:
+			qint64 *mEvaluationTime;
+			QElapsedTimer mTimer;
+
+			Q_DISABLE_COPY(EvaluationTimer)
+		};
+	}
 
 	ActionInstance::ActionInstance(const ActionDefinition *definition, QObject *parent)
 		: QObject(parent),
 		  mRuntimeId(mCurrentRuntimeId),
+		  mEvaluationTime(0),
 		  d(new ActionInstanceData())
 	{
 		d->definition = definition;
@@ -83,6 +114,7 @@ namespace ActionTools
 	ActionInstance::ActionInstance(const ActionInstance &other)
 		: QObject(),
 		  mRuntimeId(mCurrentRuntimeId),
+		  mEvaluationTime(0),
 		  d(other.d)
 	{
 		++mCurrentRuntimeId;
@@ -206,6 +238,13 @@ namespace ActionTools
 		if(!ok)
 			return QString();
 
+		if(const LiteralSubParameter *literal = literalSubParameter(parameterName, subParameterName))
+		{
+			setCurrentParameter(parameterName, subParameterName);
+
+			return literal->text;
+		}
+
 		const SubParameter &subParameter = retreiveSubParameter(parameterName, subParameterName);
 		QString result;
 
@@ -251,7 +290,7 @@ namespace ActionTools
         if(!ok || filename.isEmpty())
             return QImage();
 
-        QImage image(filename);
+        QImage image = ImageCache::instance().load(filename);
 
         if(!image.isNull())
             return image;
@@ -339,20 +378,42 @@ namespace ActionTools
 										  const QString &parameterName,
 										  const QString &subParameterName)
 	{
+		if(!ok)
+			return 0;
+
+		LiteralSubParameter *literal = literalSubParameter(parameterName, subParameterName);
+		if(literal && literal->type == LiteralSubParameter::IntegerType)
+		{
+			setCurrentParameter(parameterName, subParameterName);
+
+			return literal->value.toInt();
+		}
+
 		QString result = evaluateString(ok, parameterName, subParameterName);
 
-		if(!ok || result.isEmpty())
+		if(!ok)
 			return 0;
 
-		int intResult = result.toInt(&ok);
+		int intResult = 0;
 
-		if(!ok)
+		if(!result.isEmpty())
 		{
-			ok = false;
+			intResult = result.toInt(&ok);
 
-            emit executionException(ActionException::InvalidParameterException, tr("Integer value expected."));
+			if(!ok)
+			{
+				ok = false;
 
-			return 0;
+				emit executionException(ActionException::InvalidParameterException, tr("Integer value expected."));
+
+				return 0;
+			}
+		}
+
+		if(literal)
+		{
+			literal->type = LiteralSubParameter::IntegerType;
+			literal->value = intResult;
 		}
 
 		return intResult;
@@ -374,20 +435,42 @@ namespace ActionTools
 										const QString &parameterName,
 										const QString &subParameterName)
 	{
+		if(!ok)
+			return 0.0;
+
+		LiteralSubParameter *literal = literalSubParameter(parameterName, subParameterName);
+		if(literal && literal->type == LiteralSubParameter::DoubleType)
+		{
+			setCurrentParameter(parameterName, subParameterName);
+
+			return literal->value.toDouble();
+		}
+
 		QString result = evaluateString(ok, parameterName, subParameterName);
 
-		if(!ok || result.isEmpty())
+		if(!ok)
 			return 0.0;
 
-		double doubleResult = result.toDouble(&ok);
+		double doubleResult = 0.0;
 
-		if(!ok)
+		if(!result.isEmpty())
 		{
-			ok = false;
+			doubleResult = result.toDouble(&ok);
 
-            emit executionException(ActionException::InvalidParameterException, tr("Decimal value expected."));
+			if(!ok)
+			{
+				ok = false;
 
-			return 0.0;
+				emit executionException(ActionException::InvalidParameterException, tr("Decimal value expected."));
+
+				return 0.0;
+			}
+		}
+
+		if(literal)
+		{
+			literal->type = LiteralSubParameter::DoubleType;
+			literal->value = doubleResult;
 		}
 
 		return doubleResult;
@@ -482,6 +565,26 @@ namespace ActionTools
         if(!ok)
             return QPoint();
 
+        LiteralSubParameter *literal = literalSubParameter(parameterName, subParameterName);
+        if(literal && literal->type == LiteralSubParameter::PointType)
+        {
+            setCurrentParameter(parameterName, subParameterName);
+
+            if(!literal->value.isValid())
+            {
+                if(empty)
+                    *empty = true;
+
+                return QPoint();
+            }
+
+            QPointF point = literal->value.toPointF();
+
+            computePercentPosition(point, subParameter(parameterName, "unit"));
+
+            return QPoint(point.x(), point.y());
+        }
+
         const SubParameter &subParameter = retreiveSubParameter(parameterName, subParameterName);
         const SubParameter &unitSubParameter = retreiveSubParameter(parameterName, "unit");
         QString result;
@@ -511,6 +614,12 @@ namespace ActionTools
             if(empty)
                 *empty = true;
 
+            if(literal)
+            {
+                literal->type = LiteralSubParameter::PointType;
+                literal->value = QVariant();
+            }
+
             return QPoint();
         }
 
@@ -532,6 +641,12 @@ namespace ActionTools
             return QPoint();
 		}
 
+        if(literal)
+        {
+            literal->type = LiteralSubParameter::PointType;
+            literal->value = point;
+        }
+
         computePercentPosition(point, unitSubParameter);
 
         return QPoint(point.x(), point.y());
@@ -563,6 +678,14 @@ namespace ActionTools
 		if(!ok)
 			return QPolygon();
 
+		LiteralSubParameter *literal = literalSubParameter(parameterName, subParameterName);
+		if(literal && literal->type == LiteralSubParameter::PolygonType)
+		{
+			setCurrentParameter(parameterName, subParameterName);
+
+			return literal->value.value<QPolygon>();
+		}
+
 		const SubParameter &subParameter = retreiveSubParameter(parameterName, subParameterName);
 		QString result;
 
@@ -574,19 +697,26 @@ namespace ActionTools
 		if(!ok)
 			return QPolygon();
 
-		if(result.isEmpty() || result == ";")
-			return QPolygon();
-
-		QStringList pointStrings = result.split(';', QString::SkipEmptyParts);
 		QPolygon polygon;
 
-        for(const QString &pointString: pointStrings)
+		if(!result.isEmpty() && result != ";")
 		{
-			QStringList pointComponents = pointString.split(':', QString::SkipEmptyParts);
-			if(pointComponents.size() != 2)
-				continue;
+			QStringList pointStrings = result.split(';', QString::SkipEmptyParts);
 
-			polygon << QPoint(pointComponents.at(0).toInt(), pointComponents.at(1).toInt());
+			for(const QString &pointString: pointStrings)
+			{
+				QStringList pointComponents = pointString.split(':', QString::SkipEmptyParts);
+				if(pointComponents.size() != 2)
+					continue;
+
+				polygon << QPoint(pointComponents.at(0).toInt(), pointComponents.at(1).toInt());
+			}
+		}
+
+		if(literal)
+		{
+			literal->type = LiteralSubParameter::PolygonType;
+			literal->value = QVariant::fromValue(polygon);
 		}
 
 		return polygon;
@@ -599,6 +729,14 @@ namespace ActionTools
 		if(!ok)
 			return QColor();
 
+		LiteralSubParameter *literal = literalSubParameter(parameterName, subParameterName);
+		if(literal && literal->type == LiteralSubParameter::ColorType)
+		{
+			setCurrentParameter(parameterName, subParameterName);
+
+			return literal->value.value<QColor>();
+		}
+
 		const SubParameter &subParameter = retreiveSubParameter(parameterName, subParameterName);
 		QString result;
 
@@ -617,7 +755,15 @@ namespace ActionTools
 			return QColor();
 
 		if(result.isEmpty() || result == "::")
+		{
+			if(literal)
+			{
+				literal->type = LiteralSubParameter::ColorType;
+				literal->value = QVariant::fromValue(QColor());
+			}
+
 			return QColor();
+		}
 
 		QStringList colorStringList = result.split(":");
 		if(colorStringList.count() != 3)
@@ -637,6 +783,12 @@ namespace ActionTools
 			return QColor();
 		}
 
+		if(literal)
+		{
+			literal->type = LiteralSubParameter::ColorType;
+			literal->value = QVariant::fromValue(color);
+		}
+
         return color;
     }
 
@@ -688,19 +840,19 @@ namespace ActionTools
 
 	QString ActionInstance::nextLine() const
 	{
-		return d->scriptEngine->property("Script.nextLine").toString();
+		return d->script->nextLineString();
 	}
 
     void ActionInstance::setNextLine(const QString &nextLine, bool doNotResetPreviousActions)
 	{
-		QScriptValue scriptValue = d->scriptEngine->globalObject().property("Script");
-		scriptValue.setProperty("nextLine", d->scriptEngine->newVariant(QVariant(nextLine)));
-        scriptValue.setProperty("doNotResetPreviousActions", doNotResetPreviousActions);
+		d->script->setNextLine(nextLine);
+        d->script->setDoNotResetPreviousActions(doNotResetPreviousActions);
 	}
 
     void ActionInstance::setNextLine(int nextLine, bool doNotResetPreviousActions)
 	{
-        setNextLine(QString::number(nextLine), doNotResetPreviousActions);
+		d->script->setNextLine(nextLine);
+        d->script->setDoNotResetPreviousActions(doNotResetPreviousActions);
 	}
 
 	void ActionInstance::setArray(const QString &name, const QStringList &stringList)
@@ -748,17 +900,22 @@ namespace ActionTools
         return d->scriptEngine->globalObject().property(name);
 	}
 
-	void ActionInstance::setCurrentParameter(const QString &parameterName, const QString &subParameterName)
+	void ActionInstance::setResetNeeded()
 	{
-		d->scriptEngine->globalObject().setProperty("currentParameter", parameterName, QScriptValue::ReadOnly);
-		d->scriptEngine->globalObject().setProperty("currentSubParameter", subParameterName, QScriptValue::ReadOnly);
+		d->script->setActionNeedsReset(d->scriptLine);
 	}
 
 	SubParameter ActionInstance::retreiveSubParameter(const QString &parameterName, const QString &subParameterName)
 	{
 		setCurrentParameter(parameterName, subParameterName);
 
-        SubParameter back = subParameter(parameterName, subParameterName);
+		//Use the const data to avoid detaching the shared action data
+		const ParametersData &parametersData = d.constData()->parametersData;
+		ParametersData::const_iterator parameterIt = parametersData.constFind(parameterName);
+		if(parameterIt == parametersData.constEnd())
+			return SubParameter();
+
+        SubParameter back = parameterIt.value().subParameters().value(subParameterName);
 
         // Re-evaluate the field as code if it contains a single variable
         if(!back.isCode() && back.value().toString().startsWith(QChar('$')))
@@ -777,11 +934,63 @@ namespace ActionTools
         return back;
 	}
 
+	void ActionInstance::compileParameters()
+	{
+		mCodePrograms.clear();
+		mLiteralSubParameters.clear();
+
+		for(ParametersData::const_iterator parameterIt = d->parametersData.constBegin(); parameterIt != d->parametersData.constEnd(); ++parameterIt)
+		{
+			const SubParameterHash &subParameters = parameterIt.value().subParameters();
+
+			for(SubParameterHash::const_iterator subParameterIt = subParameters.constBegin(); subParameterIt != subParameters.constEnd(); ++subParameterIt)
+			{
+				const SubParameter &subParameter = subParameterIt.value();
+				const QString &value = subParameter.value().toString();
+
+				if(subParameter.isCode())
+				{
+					if(!value.isEmpty() && !mCodePrograms.contains(value))
+						mCodePrograms.insert(value, QScriptProgram(value));
+				}
+				else if(!value.contains(QChar('$')))
+				{
+					LiteralSubParameter literal;
+					bool ok = true;
+
+					literal.text = evaluateText(ok, value);
+					literal.type = LiteralSubParameter::TextType;
+
+					mLiteralSubParameters.insert(qMakePair(parameterIt.key(), subParameterIt.key()), literal);
+				}
+			}
+		}
+	}
+
+	ActionInstance::LiteralSubParameter *ActionInstance::literalSubParameter(const QString &parameterName, const QString &subParameterName)
+	{
+		LiteralSubParameters::iterator literalIt = mLiteralSubParameters.find(qMakePair(parameterName, subParameterName));
+		if(literalIt == mLiteralSubParameters.end())
+			return nullptr;
+
+		return &literalIt.value();
+	}
+
     QScriptValue ActionInstance::evaluateCode(bool &ok, const QString &toEvaluate)
 	{
 		ok = true;
 
-        QScriptValue result = d->scriptEngine->evaluate(toEvaluate);
+		EvaluationTimer evaluationTimer(mProfilingEnabled ? &mEvaluationTime : nullptr);
+
+        QScriptValue result;
+
+		//Code that was not known at setup time (single variable parameters) is not cached
+		QHash<QString, QScriptProgram>::const_iterator programIt = mCodePrograms.constFind(toEvaluate);
+		if(programIt == mCodePrograms.constEnd())
+			result = d->scriptEngine->evaluate(toEvaluate);
+		else
+			result = d->scriptEngine->evaluate(programIt.value());
+
 		if(result.isError())
 		{
             ok = false;
@@ -809,9 +1018,11 @@ namespace ActionTools
 	{
 		ok = true;
 
+		EvaluationTimer evaluationTimer(mProfilingEnabled ? &mEvaluationTime : nullptr);
+
         int position = 0;
 
-        return evaluateTextString(ok, toEvaluate, position);
+        return evaluateTextString(ok, toEvaluate, mTextChunks[toEvaluate], position, false);
     }
 
     QString ActionInstance::evaluateText(bool &ok, const SubParameter &toEvaluate)
@@ -819,113 +1030,152 @@ namespace ActionTools
         return evaluateText(ok, toEvaluate.value().toString());
     }
 
-    QString ActionInstance::evaluateTextString(bool &ok, const QString &toEvaluate, int &position)
+    QString ActionInstance::evaluateTextString(bool &ok, const QString &toEvaluate, TextChunks &chunks, int &position, bool nested)
 	{
 		ok = true;
 
-		int startIndex = position;
-
 		QString result;
 
-		while(position < toEvaluate.length())
+		while(true)
 		{
-			if(toEvaluate[position] == QChar('$'))
+			int chunkKey = (position << 1) | (nested ? 1 : 0);
+			TextChunks::const_iterator chunkIt = chunks.constFind(chunkKey);
+			if(chunkIt == chunks.constEnd())
+				chunkIt = chunks.insert(chunkKey, compileTextChunk(toEvaluate, position, nested));
+
+			//Copy the chunk, since evaluating array indexes can add new chunks
+			const TextChunk chunk = chunkIt.value();
+
+			result.append(chunk.literal);
+
+			if(chunk.terminator != TextChunk::Variable)
 			{
-				//find a variable name
-				if(VariableRegExp.indexIn(toEvaluate, position) != -1)
-				{
-					QString foundVariableName = VariableRegExp.cap(1);
-					QScriptValue foundVariable = d->scriptEngine->globalObject().property(foundVariableName);
+				position = chunk.position;
 
-					position += foundVariableName.length();
+				return result;
+			}
 
-					if(!foundVariable.isValid())
-					{
-						ok = false;
+			QScriptValue foundVariable = d->scriptEngine->globalObject().property(chunk.variable);
 
-						emit executionException(ActionException::InvalidParameterException, tr("Undefined variable \"%1\"").arg(foundVariableName));
-						return QString();
-					}
+			position = chunk.position + chunk.variableName.length();
 
-					QString stringEvaluationResult;
+			if(!foundVariable.isValid())
+			{
+				ok = false;
+
+				emit executionException(ActionException::InvalidParameterException, tr("Undefined variable \"%1\"").arg(chunk.variableName));
+				return QString();
+			}
 
-					if(foundVariable.isNull())
-						stringEvaluationResult = "[Null]";
-					else if(foundVariable.isUndefined())
-						stringEvaluationResult = "[Undefined]";
-					else if(foundVariable.isArray())
+			QString stringEvaluationResult;
+
+			if(foundVariable.isNull())
+				stringEvaluationResult = "[Null]";
+			else if(foundVariable.isUndefined())
+				stringEvaluationResult = "[Undefined]";
+			else if(foundVariable.isArray())
+			{
+				while((position + 1 < toEvaluate.length()) && toEvaluate[position + 1] == QChar('['))
+				{
+					position += 2;
+					QString indexArray = evaluateTextString(ok, toEvaluate, chunks, position, true);
+
+					if(!ok)
+						return QString();
+
+					if((position < toEvaluate.length()) && toEvaluate[position] == QChar(']'))
 					{
-						while((position + 1 < toEvaluate.length()) && toEvaluate[position + 1] == QChar('['))
-						{
-							position += 2;
-							QString indexArray = evaluateTextString(ok, toEvaluate, position);
-
-							if((position < toEvaluate.length()) && toEvaluate[position] == QChar(']'))
-							{
-								QScriptString internalIndexArray = d->scriptEngine->toStringHandle(indexArray);
-								bool flag = true;
-								int numIndex = internalIndexArray.toArrayIndex(&flag);
-
-								if(flag) //numIndex is valid
-									foundVariable = foundVariable.property(numIndex);
-								else //use internalIndexArray
-									foundVariable = foundVariable.property(internalIndexArray);
-							}
-							else
-							{
-								//syntax error
-								ok = false;
-
-								emit executionException(ActionException::InvalidParameterException, tr("Invalid parameter. Unable to evaluate string"));
-								return QString();
-							}
-
-							//COMPATIBILITY: we break the while loop if foundVariable is no more of Array type
-							if(!foundVariable.isArray())
-								break;
-						}
-						//end of while, no more '['
-						if(foundVariable.isArray())
-							stringEvaluationResult = evaluateVariableArray(ok, foundVariable);
-						else
-							stringEvaluationResult = foundVariable.toString();
+						QScriptString internalIndexArray = d->scriptEngine->toStringHandle(indexArray);
+						bool flag = true;
+						int numIndex = internalIndexArray.toArrayIndex(&flag);
+
+						if(flag) //numIndex is valid
+							foundVariable = foundVariable.property(numIndex);
+						else //use internalIndexArray
+							foundVariable = foundVariable.property(internalIndexArray);
 					}
-					else if(foundVariable.isVariant())
+					else
 					{
-						QVariant variantEvaluationResult = foundVariable.toVariant();
-						switch(variantEvaluationResult.type())
-						{
-						case QVariant::StringList:
-							stringEvaluationResult = variantEvaluationResult.toStringList().join("\n");
-							break;
-						case QVariant::ByteArray:
-							stringEvaluationResult = "[Raw data]";
-							break;
-						default:
-							stringEvaluationResult = foundVariable.toString();
-							break;
-						}
+						//syntax error
+						ok = false;
+
+						emit executionException(ActionException::InvalidParameterException, tr("Invalid parameter. Unable to evaluate string"));
+						return QString();
 					}
-					else
-						stringEvaluationResult = foundVariable.toString();
 
-					result.append(stringEvaluationResult);
+					//COMPATIBILITY: we break the while loop if foundVariable is no more of Array type
+					if(!foundVariable.isArray())
+						break;
 				}
+				//end of while, no more '['
+				if(foundVariable.isArray())
+					stringEvaluationResult = evaluateVariableArray(ok, foundVariable);
+				else
+					stringEvaluationResult = foundVariable.toString();
+			}
+			else if(foundVariable.isVariant())
+			{
+				QVariant variantEvaluationResult = foundVariable.toVariant();
+				switch(variantEvaluationResult.type())
+				{
+				case QVariant::StringList:
+					stringEvaluationResult = variantEvaluationResult.toStringList().join("\n");
+					break;
+				case QVariant::ByteArray:
+					stringEvaluationResult = "[Raw data]";
+					break;
+				default:
+					stringEvaluationResult = foundVariable.toString();
+					break;
+				}
+			}
+			else
+				stringEvaluationResult = foundVariable.toString();
+
+			result.append(stringEvaluationResult);
+
+			position++;
+		}
+	}
+
+	ActionInstance::TextChunk ActionInstance::compileTextChunk(const QString &toEvaluate, int position, bool nested) const
+	{
+		TextChunk chunk;
+		chunk.terminator = TextChunk::End;
+
+		while(position < toEvaluate.length())
+		{
+			if(toEvaluate[position] == QChar('$'))
+			{
+				//find a variable name
+				if(VariableRegExp.indexIn(toEvaluate, position) != -1)
+				{
+					chunk.terminator = TextChunk::Variable;
+					chunk.variableName = VariableRegExp.cap(1);
+					chunk.variable = d->scriptEngine->toStringHandle(chunk.variableName);
+					chunk.position = position;
 
+					return chunk;
+				}
 			}
 			else if (toEvaluate[position] == QChar(']'))
 			{
-				if(startIndex == 0)
+				if(!nested)
 					//in top level evaluation isolated character ']' is accepted (for compatibility reason), now prefer "\]"
 					//i.e without matching '['
-					result.append(toEvaluate[position]);
+					chunk.literal.append(toEvaluate[position]);
 				else
+				{
 					//on other levels, the parsing is stopped at this point
-					return result;
+					chunk.terminator = TextChunk::CloseBracket;
+					chunk.position = position;
+
+					return chunk;
+				}
 			}
 			else if(toEvaluate[position] == QChar('\\'))
 			{
-				if(startIndex == 0)
+				if(!nested)
 				{
 					//for ascendant compatibility reason
 					//in top level evaluation '\' is not only an escape character,
@@ -934,30 +1184,32 @@ namespace ActionTools
 					{
 						position++;
 						if(toEvaluate[position] == QChar('$') || toEvaluate[position] == QChar('[') || toEvaluate[position] == QChar(']') || toEvaluate[position] == QChar('\\'))
-							result.append(toEvaluate[position]);
+							chunk.literal.append(toEvaluate[position]);
 						else
 						{
 							position--;
-							result.append(toEvaluate[position]);
+							chunk.literal.append(toEvaluate[position]);
 						}
 					}
 					else
-						result.append(toEvaluate[position]);
+						chunk.literal.append(toEvaluate[position]);
 				}
 				else
 				{
 					position++;
 					if( position < toEvaluate.length() )
-						result.append(toEvaluate[position]);
+						chunk.literal.append(toEvaluate[position]);
 				}
 			}
 			else
-				result.append(toEvaluate[position]);
+				chunk.literal.append(toEvaluate[position]);
 
 			position++;
 		}
 
-		return result;
+		chunk.position = position;
+
+		return chunk;
 	}
 
 	QDataStream &operator << (QDataStream &s, const ActionInstance &actionInstance)
@@ -31,6 +31,8 @@
 #include <QSharedData>
 #include <QColor>
 #include <QScriptValue>
+#include <QScriptProgram>
+#include <QScriptString>
 #include <QVariant>
 
 class QScriptEngine;
@@ -148,9 +150,22 @@ namespace ActionTools
 
 		qint64 runtimeId() const											{ return mRuntimeId; }
 
+		//Parameter being evaluated, used to locate errors and console messages
+		const QString &currentParameter() const								{ return mCurrentParameter; }
+		const QString &currentSubParameter() const							{ return mCurrentSubParameter; }
+
+		//Time spent evaluating parameters since the last clearEvaluationTime(), only measured when profiling is enabled
+		static void setProfilingEnabled(bool profilingEnabled)				{ mProfilingEnabled = profilingEnabled; }
+		static bool isProfilingEnabled()									{ return mProfilingEnabled; }
+		qint64 evaluationTime() const										{ return mEvaluationTime; }
+		void clearEvaluationTime()											{ mEvaluationTime = 0; }
+
         bool callProcedure(const QString &procedureName);
 
-		virtual void reset()												{}//This is called when this action should reset its counter (for loops)
+		//This is called when this action should reset its counter (for loops), after a backward jump over it.
+		//It is only called if setResetNeeded() has been called since the last reset: an action that overrides reset()
+		//has to call setResetNeeded() when it starts holding some state (typically in startExecution()), or it will never be reset.
+		virtual void reset()												{}
 		virtual void startExecution()										{}//This is called when the action should start its execution
 		virtual void stopExecution()										{}//This is called when the action should break its execution
 		virtual void stopLongTermExecution()								{}//This is called on script execution end, the action should stop its long term actions (ie continuous press of a key)
@@ -162,6 +177,17 @@ namespace ActionTools
 			d->scriptEngine = scriptEngine;
 			d->script = script;
 			d->scriptLine = scriptLine;
+
+			mTextChunks.clear();
+			compileParameters();
+		}
+
+		//Releases the compiled parameters, unloading their programs from the script engine
+		void clearExecution()
+		{
+			mCodePrograms.clear();
+			mTextChunks.clear();
+			mLiteralSubParameters.clear();
 		}
 
 		void copyActionDataFrom(const ActionInstance &other);
@@ -225,6 +251,14 @@ namespace ActionTools
 			if(!ok)
 				return T();
 
+			LiteralSubParameter *literal = literalSubParameter(parameterName, subParameterName);
+			if(literal && literal->type == LiteralSubParameter::ListIndexType)
+			{
+				setCurrentParameter(parameterName, subParameterName);
+
+				return static_cast<T>(literal->value.toInt());
+			}
+
 			const SubParameter &subParameter = retreiveSubParameter(parameterName, subParameterName);
 			QString result;
 
@@ -236,45 +270,45 @@ namespace ActionTools
 			if(!ok)
 				return T();
 
-			//Search in the non-translated items
-			for(int i=0;i<listElements.first.size();++i)
-			{
-				if(listElements.first.at(i) == result)
-					return static_cast<T>(i);
-			}
+			int index = listElements.first.indexOf(result);//Search in the non-translated items
+
+			if(index == -1)
+				index = listElements.second.indexOf(result);//Then search in the translated items
 
-			//Then search in the translated items
-			for(int i=0;i<listElements.second.size();++i)
+			if(index == -1)
 			{
-				if(listElements.second.at(i) == result)
-					return static_cast<T>(i);
-			}
+				if(result.isEmpty())
+				{
+					ok = false;
 
-            if(result.isEmpty())
-            {
-                ok = false;
+					setCurrentParameter(parameterName, subParameterName);
 
-                setCurrentParameter(parameterName, subParameterName);
+					emit executionException(ActionException::InvalidParameterException, tr("Please choose a value for this field."));
 
-                emit executionException(ActionException::InvalidParameterException, tr("Please choose a value for this field."));
+					return T();
+				}
 
-                return T();
-            }
+				index = result.toInt(&ok);
 
-			T back = static_cast<T>(result.toInt(&ok));
+				if(!ok || index < 0 || index >= listElements.first.count())
+				{
+					ok = false;
 
-			if(!ok || back < 0 || back >= listElements.first.count())
-			{
-				ok = false;
+					setCurrentParameter(parameterName, subParameterName);
 
-                setCurrentParameter(parameterName, subParameterName);
+					emit executionException(ActionException::InvalidParameterException, tr("\"%1\" is an invalid value.").arg(result));
 
-				emit executionException(ActionException::InvalidParameterException, tr("\"%1\" is an invalid value.").arg(result));
+					return T();
+				}
+			}
 
-				return T();
+			if(literal)
+			{
+				literal->type = LiteralSubParameter::ListIndexType;
+				literal->value = index;
 			}
 
-			return back;
+			return static_cast<T>(index);
 		}
 
         QString evaluateEditableListElement(bool &ok,
@@ -311,9 +345,55 @@ namespace ActionTools
 		void setVariable(const QString &name, const QScriptValue &value);
 		QScriptValue variable(const QString &name);
 
-		void setCurrentParameter(const QString &parameterName, const QString &subParameterName = "value");
+		void setResetNeeded();
+
+		void setCurrentParameter(const QString &parameterName, const QString &subParameterName = "value")
+		{
+			mCurrentParameter = parameterName;
+			mCurrentSubParameter = subParameterName;
+		}
 
 	private:
+		//Part of a text parameter: a literal run, already unescaped, followed by what stopped the parsing
+		struct TextChunk
+		{
+			enum Terminator
+			{
+				End,
+				CloseBracket,
+				Variable
+			};
+
+			QString literal;
+			Terminator terminator;
+			QString variableName;
+			QScriptString variable;
+			int position;//Position of the terminator in the source text
+		};
+		using TextChunks = QHash<int, TextChunk>;//Keyed by start position and nesting level
+
+		//Subparameter that is neither code nor contains variables: its value cannot change during an execution
+		struct LiteralSubParameter
+		{
+			enum Type
+			{
+				TextType,
+				IntegerType,
+				DoubleType,
+				PointType,
+				ColorType,
+				PolygonType,
+				ListIndexType
+			};
+
+			QString text;//Result of the text evaluation
+			Type type;//Type of the converted value
+			QVariant value;
+		};
+		using LiteralSubParameters = QHash<QPair<QString, QString>, LiteralSubParameter>;//Keyed by parameter and subparameter names
+
+		void compileParameters();
+		LiteralSubParameter *literalSubParameter(const QString &parameterName, const QString &subParameterName);
 		SubParameter retreiveSubParameter(const QString &parameterName, const QString &subParameterName);
         QScriptValue evaluateCode(bool &ok, const QString &toEvaluate);
         QScriptValue evaluateCode(bool &ok, const SubParameter &toEvaluate);
@@ -322,11 +402,19 @@ namespace ActionTools
 
         QString evaluateText(bool &ok, const QString &toEvaluate);
         QString evaluateText(bool &ok, const SubParameter &toEvaluate);
-		QString evaluateTextString(bool &ok, const QString &toEvaluate, int &pos);
+		QString evaluateTextString(bool &ok, const QString &toEvaluate, TextChunks &chunks, int &position, bool nested);
+		TextChunk compileTextChunk(const QString &toEvaluate, int position, bool nested) const;
 
 		static qint64 mCurrentRuntimeId;
+		static bool mProfilingEnabled;
 
 		qint64 mRuntimeId;
+		qint64 mEvaluationTime;//In nanoseconds
+		QString mCurrentParameter;
+		QString mCurrentSubParameter;
+		QHash<QString, QScriptProgram> mCodePrograms;//Compiled code parameters, keyed by source
+		QHash<QString, TextChunks> mTextChunks;//Compiled text parameters, keyed by source
+		LiteralSubParameters mLiteralSubParameters;
 
 		QSharedDataPointer<ActionInstanceData> d;
 	};
@@ -20,6 +20,7 @@
 
 #include "actionpack.h"
 #include "actiondefinition.h"
+#include "code/codetools.h"
 
 namespace ActionTools
 {
@@ -30,13 +31,6 @@ namespace ActionTools
 
 	void ActionPack::addCodeStaticMethod(QScriptEngine::FunctionSignature method, const QString &objectName, const QString &methodName, QScriptEngine *scriptEngine) const
 	{
-		QScriptValue classMetaObject = scriptEngine->globalObject().property(objectName);
-		if(!classMetaObject.isValid())
-		{
-			classMetaObject = scriptEngine->newObject();
-			scriptEngine->globalObject().setProperty(objectName, classMetaObject);
-		}
-
-		classMetaObject.setProperty(methodName, scriptEngine->newFunction(method));
+		Code::CodeTools::addClassGlobalFunctionToScriptEngine(objectName, method, methodName, scriptEngine);
 	}
 }
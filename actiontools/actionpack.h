@@ -23,6 +23,7 @@
 
 #include "actiontools_global.h"
 #include "version.h"
+#include "code/codetools.h"
 
 #include <QScriptValue>
 #include <QScriptEngine>
@@ -60,8 +61,8 @@ namespace ActionTools
 		template<typename T>
 		void addCodeClass(const QString &objectName, QScriptEngine *scriptEngine) const
 		{
-			QScriptValue metaObject = scriptEngine->newQMetaObject(&T::staticMetaObject, scriptEngine->newFunction(&T::constructor));
-			scriptEngine->globalObject().setProperty(objectName, metaObject);
+			//The class is only created when a script uses it
+			Code::CodeTools::addLazyClassToScriptEngine<T>(objectName, scriptEngine);
 		}
 
 		void addCodeStaticMethod(QScriptEngine::FunctionSignature method, const QString &objectName, const QString &methodName, QScriptEngine *scriptEngine) const;
@@ -63,7 +63,9 @@ SOURCES += actionfactory.cpp \
     screenshotwizard.cpp \
     screenshotwizardpage.cpp \
     savescreenshotwizardpage.cpp \
-    parametercontainer.cpp
+    parametercontainer.cpp \
+    consolemodel.cpp \
+    imagecache.cpp
 HEADERS += actiontools_global.h \
     actionpack.h \
     actionfactory.h \
@@ -113,7 +115,9 @@ HEADERS += actiontools_global.h \
     resourcenamedialog.h \
     screenshotwizard.h \
     screenshotwizardpage.h \
-    savescreenshotwizardpage.h
+    savescreenshotwizardpage.h \
+    consolemodel.h \
+    imagecache.h
 equals(QT_MAJOR_VERSION, 4) {
 SOURCES += nativeeventfilteringapplication.cpp
 HEADERS += nativeeventfilteringapplication.h \
@@ -22,11 +22,44 @@
 
 #include <QStringList>
 #include <QScriptEngine>
+#include <QScriptValueIterator>
 
 namespace Code
 {
+	void CodeTools::addLazyGlobalToScriptEngine(const QString &name, LazyGlobalInstaller installer, QScriptEngine *scriptEngine)
+	{
+		QScriptValue globalObject = scriptEngine->globalObject();
+
+		//Pending lazy globals are kept in the global object data, so that functions can be added to them before they are created
+		QScriptValue lazyGlobals = globalObject.data();
+		if(!lazyGlobals.isObject())
+		{
+			lazyGlobals = scriptEngine->newObject();
+			globalObject.setData(lazyGlobals);
+		}
+
+		QScriptValue lazyGlobal = scriptEngine->newObject();
+		lazyGlobal.setProperty("name", name);
+		lazyGlobal.setProperty("functions", scriptEngine->newObject());
+		lazyGlobals.setProperty(name, lazyGlobal);
+
+		//The installer is given to the accessor as its native argument, scripts cannot see it
+		QScriptValue accessor = scriptEngine->newFunction(&lazyGlobalAccessor, reinterpret_cast<void *>(installer));
+		accessor.setData(lazyGlobal);
+
+		globalObject.setProperty(name, accessor, QScriptValue::PropertyGetter | QScriptValue::PropertySetter);
+	}
+
 	void CodeTools::addClassGlobalFunctionToScriptEngine(const QString &className, QScriptEngine::FunctionSignature function, const QString &functionName, QScriptEngine *scriptEngine)
 	{
+		//Reading a lazy global would create it: add the function once it is created instead
+		QScriptValue lazyGlobal = scriptEngine->globalObject().data().property(className);
+		if(lazyGlobal.isObject())
+		{
+			lazyGlobal.property("functions").setProperty(functionName, scriptEngine->newFunction(function));
+			return;
+		}
+
 		QScriptValue classMetaObject = scriptEngine->globalObject().property(className);
 		if(!classMetaObject.isValid())
 		{
@@ -37,6 +70,38 @@ namespace Code
 		classMetaObject.setProperty(functionName, scriptEngine->newFunction(function));
 	}
 
+	QScriptValue CodeTools::lazyGlobalAccessor(QScriptContext *context, QScriptEngine *engine, void *installer)
+	{
+		QScriptValue lazyGlobal = context->callee().data();
+		QString name = lazyGlobal.property("name").toString();
+		QScriptValue globalObject = engine->globalObject();
+
+		//Remove the accessor, the global then becomes a plain property
+		globalObject.setProperty(name, QScriptValue());
+		globalObject.data().setProperty(name, QScriptValue());
+
+		//Assigned before being read: there is nothing to create
+		if(context->argumentCount() == 1)
+		{
+			globalObject.setProperty(name, context->argument(0));
+			return context->argument(0);
+		}
+
+		reinterpret_cast<LazyGlobalInstaller>(installer)(name, engine);
+
+		QScriptValue value = globalObject.property(name);
+
+		QScriptValueIterator it(lazyGlobal.property("functions"));
+		while(it.hasNext())
+		{
+			it.next();
+
+			value.setProperty(it.name(), it.value());
+		}
+
+		return value;
+	}
+
 	QString CodeTools::removeCodeNamespace(const QString &className)
 	{
 		if(className.startsWith("Code::"))
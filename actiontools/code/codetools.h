@@ -44,6 +44,17 @@ namespace Code
 			addClassToScriptEngine<T>(removeCodeNamespace(T::staticMetaObject.className()), scriptEngine);
 		}
 
+		//Lazy globals are only created when a script first accesses them, the installer has to set the global property called name
+		using LazyGlobalInstaller = void (*)(const QString &name, QScriptEngine *scriptEngine);
+
+		static void addLazyGlobalToScriptEngine(const QString &name, LazyGlobalInstaller installer, QScriptEngine *scriptEngine);
+
+		template<typename T>
+		static void addLazyClassToScriptEngine(const QString &name, QScriptEngine *scriptEngine)
+		{
+			addLazyGlobalToScriptEngine(name, &installClass<T>, scriptEngine);
+		}
+
 		static void addClassGlobalFunctionToScriptEngine(const QString &className, QScriptEngine::FunctionSignature function, const QString &functionName, QScriptEngine *scriptEngine);
 
 		template<typename T>
@@ -53,6 +64,13 @@ namespace Code
 		}
 
 	private:
+		template<typename T>
+		static void installClass(const QString &name, QScriptEngine *scriptEngine)
+		{
+			addClassToScriptEngine<T>(name, scriptEngine);
+		}
+
+		static QScriptValue lazyGlobalAccessor(QScriptContext *context, QScriptEngine *engine, void *installer);
 		static QString removeCodeNamespace(const QString &className);
 	};
 }
@@ -29,6 +29,7 @@
 #include "opencvalgorithms.h"
 #include "qtimagefilters/QtImageFilterFactory"
 #include "screenshooter.h"
+#include "imagecache.h"
 
 #include <QBuffer>
 #include <QScriptValueIterator>
@@ -289,12 +290,15 @@ namespace Code
 	
 	QScriptValue Image::loadFromFile(const QString &filename)
 	{
-		if(!mImage.load(filename))
+		QImage image = ActionTools::ImageCache::instance().load(filename);
+		if(image.isNull())
 		{
 			throwError("LoadImageError", tr("Unable to load image from file %1").arg(filename));
 			return thisObject();
 		}
-	
+
+		mImage = image;
+
 		return thisObject();
 	}
 	
@@ -477,7 +481,8 @@ namespace Code
 			int searchExpansion;
             AlgorithmMethod method;
 
-            findSubImageOptions(options, &confidenceMinimum, &downPyramidCount, &searchExpansion, &method);
+            if(!findSubImageOptions(options, &confidenceMinimum, &downPyramidCount, &searchExpansion, &method))
+                return QScriptValue();
 
             if(!mOpenCVAlgorithms->findSubImage(QList<QImage>() << mImage, codeImage->image(), matchingPointList, confidenceMinimum, 1, downPyramidCount, searchExpansion, static_cast<ActionTools::OpenCVAlgorithms::AlgorithmMethod>(method)))
 			{
@@ -520,7 +525,8 @@ namespace Code
             AlgorithmMethod method;
 			int maximumMatches;
 
-            findSubImageOptions(options, &confidenceMinimum, &downPyramidCount, &searchExpansion, &method, &maximumMatches);
+            if(!findSubImageOptions(options, &confidenceMinimum, &downPyramidCount, &searchExpansion, &method, &maximumMatches))
+                return QScriptValue();
 
             if(!mOpenCVAlgorithms->findSubImage(QList<QImage>() << mImage, codeImage->image(), matchingPointList, confidenceMinimum, maximumMatches, downPyramidCount, searchExpansion, static_cast<ActionTools::OpenCVAlgorithms::AlgorithmMethod>(method)))
 			{
@@ -576,7 +582,8 @@ namespace Code
 			int searchExpansion;
             AlgorithmMethod method;
 
-            findSubImageOptions(options, &confidenceMinimum, &downPyramidCount, &searchExpansion, &method);
+            if(!findSubImageOptions(options, &confidenceMinimum, &downPyramidCount, &searchExpansion, &method))
+                return QScriptValue();
 
             if(!mOpenCVAlgorithms->findSubImageAsync(QList<QImage>() << mImage, codeImage->image(), confidenceMinimum, 1, downPyramidCount, searchExpansion, static_cast<ActionTools::OpenCVAlgorithms::AlgorithmMethod>(method)))
 			{
@@ -613,7 +620,8 @@ namespace Code
             AlgorithmMethod method;
 			int maximumMatches;
 
-            findSubImageOptions(options, &confidenceMinimum, &downPyramidCount, &searchExpansion, &method, &maximumMatches);
+            if(!findSubImageOptions(options, &confidenceMinimum, &downPyramidCount, &searchExpansion, &method, &maximumMatches))
+                return QScriptValue();
 
             if(!mOpenCVAlgorithms->findSubImageAsync(QList<QImage>() << mImage, codeImage->image(), confidenceMinimum, maximumMatches, downPyramidCount, searchExpansion, static_cast<ActionTools::OpenCVAlgorithms::AlgorithmMethod>(method)))
 			{
@@ -680,7 +688,7 @@ namespace Code
 		}
 	}
 
-    void Image::findSubImageOptions(const QScriptValue &options, int *confidenceMinimum, int *downPyramidCount, int *searchExpansion, AlgorithmMethod *method, int *maximumMatches) const
+    bool Image::findSubImageOptions(const QScriptValue &options, int *confidenceMinimum, int *downPyramidCount, int *searchExpansion, AlgorithmMethod *method, int *maximumMatches) const
 	{
 		QScriptValueIterator it(options);
 
@@ -714,5 +722,19 @@ namespace Code
             else if(searchExpansion && it.name() == "method")
                 *method = static_cast<AlgorithmMethod>(it.value().toInt32());
 		}
+
+		if(downPyramidCount && *downPyramidCount < 0)
+		{
+			throwError("FindSubImageError", tr("Invalid down pyramid count: %1").arg(*downPyramidCount));
+			return false;
+		}
+
+		if(maximumMatches && *maximumMatches < 1)
+		{
+			throwError("FindSubImageError", tr("Invalid maximum matches count: %1").arg(*maximumMatches));
+			return false;
+		}
+
+		return true;
 	}
 }
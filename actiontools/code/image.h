@@ -126,7 +126,7 @@ namespace Code
 		void findSubImageAsyncFinished(const ActionTools::MatchingPointList &matchingPointList);
 
 	private:
-        void findSubImageOptions(const QScriptValue &options, int *confidenceMinimum, int *downPyramidCount, int *searchExpansion, AlgorithmMethod *method, int *maximumMatches = 0) const;
+        bool findSubImageOptions(const QScriptValue &options, int *confidenceMinimum, int *downPyramidCount, int *searchExpansion, AlgorithmMethod *method, int *maximumMatches = 0) const;
 
 		enum FilterOption
 		{
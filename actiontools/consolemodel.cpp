@@ -0,0 +1,273 @@
+/*
+	Actiona
+	Copyright (C) 2005-2017 Jonathan Mercier-Ganady
+
+	Actiona is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Actiona is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+	Contact : jmgr@jmgr.info
+*/
+
+#include "consolemodel.h"
+
+#include <QApplication>
+#include <QBrush>
+
+namespace ActionTools
+{
+	ConsoleRecord::ConsoleRecord()
+		: type(ConsoleWidget::Information),
+		  source(ConsoleWidget::DesignError),
+		  actionRuntimeId(-1),
+		  field(-1),
+		  subField(-1),
+		  line(-1),
+		  column(-1),
+		  value(-1)
+	{
+	}
+
+	ConsoleModel::ConsoleModel(QObject *parent)
+		: QAbstractTableModel(parent),
+		  mFirst(0),
+		  mCount(0),
+		  mCapacity(DefaultCapacity),
+		  mInformationIcon(":/images/information.png"),
+		  mWarningIcon(":/images/warning.png"),
+		  mErrorIcon(":/images/error.png"),
+		  mSeparatorFont(QApplication::font())
+	{
+		mSeparatorFont.setPointSize(7);
+	}
+
+	void ConsoleModel::setCapacity(int capacity)
+	{
+		capacity = qMax(capacity, 1);
+		if(capacity == mCapacity)
+			return;
+
+		QVector<ConsoleRecord> records;
+		int keptCount = qMin(mCount, capacity);
+		records.reserve(keptCount);
+		for(int row = mCount - keptCount; row < mCount; ++row)
+			records.append(record(row));
+
+		mCapacity = capacity;
+
+		resetRecords(records);
+	}
+
+	int ConsoleModel::internString(const QString &string)
+	{
+		if(string.isEmpty())
+			return -1;
+
+		QHash<QString, int>::const_iterator it = mStringIndexes.constFind(string);
+		if(it != mStringIndexes.constEnd())
+			return it.value();
+
+		int index = mStrings.size();
+		mStrings.append(string);
+		mStringIndexes.insert(string, index);
+
+		return index;
+	}
+
+	void ConsoleModel::appendRecord(const ConsoleRecord &record)
+	{
+		appendRecords(QVector<ConsoleRecord>() << record);
+	}
+
+	void ConsoleModel::appendRecords(QVector<ConsoleRecord> records)
+	{
+		if(records.isEmpty())
+			return;
+
+		if(records.size() > mCapacity)
+			records.remove(0, records.size() - mCapacity);
+
+		//The buffer grows until it reaches its capacity, it only wraps around once full
+		if(mFirst == 0 && mRecords.size() < mCapacity)
+			mRecords.resize(qMin(mCapacity, qMax(mRecords.size(), mCount + records.size())));
+
+		int evictedCount = mCount + records.size() - mCapacity;
+		if(evictedCount > 0)
+		{
+			beginRemoveRows(QModelIndex(), 0, evictedCount - 1);
+
+			for(int index = 0; index < evictedCount; ++index)
+				mRecords[(mFirst + index) % mRecords.size()] = ConsoleRecord();
+
+			mFirst = (mFirst + evictedCount) % mRecords.size();
+			mCount -= evictedCount;
+
+			endRemoveRows();
+		}
+
+		beginInsertRows(QModelIndex(), mCount, mCount + records.size() - 1);
+
+		for(const ConsoleRecord &newRecord: records)
+		{
+			mRecords[(mFirst + mCount) % mRecords.size()] = newRecord;
+			++mCount;
+		}
+
+		endInsertRows();
+	}
+
+	void ConsoleModel::appendPendingRecords()
+	{
+		if(mPendingRecords.isEmpty())
+			return;
+
+		QVector<ConsoleRecord> records;
+		records.swap(mPendingRecords);
+
+		appendRecords(records);
+	}
+
+	void ConsoleModel::clear()
+	{
+		mPendingRecords.clear();
+
+		//Interned strings are kept since lines waiting to be added can refer to them
+		resetRecords(QVector<ConsoleRecord>());
+	}
+
+	void ConsoleModel::clearExceptSeparators()
+	{
+		mPendingRecords.clear();
+
+		QVector<ConsoleRecord> separators;
+		for(int row = 0; row < mCount; ++row)
+		{
+			const ConsoleRecord &currentRecord = record(row);
+			if(currentRecord.type == ConsoleWidget::Separator)
+				separators.append(currentRecord);
+		}
+
+		if(separators.size() == mCount)
+			return;
+
+		resetRecords(separators);
+	}
+
+	int ConsoleModel::rowCount(const QModelIndex &parent) const
+	{
+		if(parent.isValid())
+			return 0;
+
+		return mCount;
+	}
+
+	int ConsoleModel::columnCount(const QModelIndex &parent) const
+	{
+		if(parent.isValid())
+			return 0;
+
+		return 1;
+	}
+
+	QVariant ConsoleModel::data(const QModelIndex &index, int role) const
+	{
+		if(!index.isValid() || index.row() >= mCount)
+			return QVariant();
+
+		const ConsoleRecord &currentRecord = record(index.row());
+
+		if(currentRecord.type == ConsoleWidget::Separator)
+		{
+			switch(role)
+			{
+			case Qt::DisplayRole:
+				return currentRecord.message;
+			case Qt::TextAlignmentRole:
+				return static_cast<int>(Qt::AlignCenter);
+			case Qt::BackgroundRole:
+				return QBrush(Qt::lightGray);
+			case Qt::ForegroundRole:
+				return QBrush(Qt::white);
+			case Qt::FontRole:
+				return mSeparatorFont;
+			case ConsoleWidget::TypeRole:
+				return QVariant::fromValue<ConsoleWidget::Type>(currentRecord.type);
+			default:
+				return QVariant();
+			}
+		}
+
+		switch(role)
+		{
+		case Qt::DisplayRole:
+			return currentRecord.message;
+		case Qt::ToolTipRole:
+			if(currentRecord.source == ConsoleWidget::DesignError)
+				return currentRecord.message;
+			return currentRecord.message + tr("\nDouble-click to show");
+		case Qt::DecorationRole:
+			switch(currentRecord.type)
+			{
+			case ConsoleWidget::Information:
+				return mInformationIcon;
+			case ConsoleWidget::Warning:
+				return mWarningIcon;
+			case ConsoleWidget::Error:
+				return mErrorIcon;
+			default:
+				return QVariant();
+			}
+		case ConsoleWidget::TypeRole:
+			return QVariant::fromValue<ConsoleWidget::Type>(currentRecord.type);
+		case ConsoleWidget::SourceRole:
+			return QVariant::fromValue<ConsoleWidget::Source>(currentRecord.source);
+		case ConsoleWidget::LineRole:
+			return currentRecord.line;
+		case ConsoleWidget::ColumnRole:
+			return currentRecord.column;
+		case ConsoleWidget::ActionRole:
+			return currentRecord.actionRuntimeId;
+		case ConsoleWidget::FieldRole:
+			return string(currentRecord.field);
+		case ConsoleWidget::SubFieldRole:
+			return string(currentRecord.subField);
+		case ConsoleWidget::BacktraceRole:
+			return currentRecord.backtrace;
+		case ConsoleWidget::ParameterRole:
+		case ConsoleWidget::ExceptionRole:
+			return currentRecord.value;
+		case ConsoleWidget::ResourceRole:
+			return string(currentRecord.value);
+		default:
+			return QVariant();
+		}
+	}
+
+	Qt::ItemFlags ConsoleModel::flags(const QModelIndex &index) const
+	{
+		if(!index.isValid() || index.row() >= mCount || record(index.row()).type == ConsoleWidget::Separator)
+			return Qt::NoItemFlags;
+
+		return Qt::ItemIsSelectable | Qt::ItemIsEnabled;
+	}
+
+	void ConsoleModel::resetRecords(const QVector<ConsoleRecord> &records)
+	{
+		beginResetModel();
+
+		mRecords = records;
+		mFirst = 0;
+		mCount = records.size();
+
+		endResetModel();
+	}
+}
@@ -0,0 +1,105 @@
+/*
+	Actiona
+	Copyright (C) 2005-2017 Jonathan Mercier-Ganady
+
+	Actiona is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Actiona is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+	Contact : jmgr@jmgr.info
+*/
+
+#ifndef CONSOLEMODEL_H
+#define CONSOLEMODEL_H
+
+#include "actiontools_global.h"
+#include "consolewidget.h"
+
+#include <QAbstractTableModel>
+#include <QVector>
+#include <QHash>
+#include <QStringList>
+#include <QIcon>
+#include <QFont>
+
+namespace ActionTools
+{
+	//Console line, with the data needed to locate its origin
+	struct ACTIONTOOLSSHARED_EXPORT ConsoleRecord
+	{
+		ConsoleRecord();
+
+		QString message;
+		ConsoleWidget::Type type;
+		ConsoleWidget::Source source;
+		qint64 actionRuntimeId;
+		int field;//Interned
+		int subField;//Interned
+		int line;
+		int column;
+		int value;//Parameter for Parameters lines, exception for Exception lines, interned resource key for Resources lines
+		QStringList backtrace;
+	};
+
+	//Console lines, kept in a ring buffer: the oldest lines are removed when the capacity is reached
+	class ACTIONTOOLSSHARED_EXPORT ConsoleModel : public QAbstractTableModel
+	{
+		Q_OBJECT
+
+	public:
+		static const int DefaultCapacity = 10000;
+
+		explicit ConsoleModel(QObject *parent = 0);
+
+		void setCapacity(int capacity);
+		int capacity() const												{ return mCapacity; }
+
+		int internString(const QString &string);
+
+		void appendRecord(const ConsoleRecord &record);
+		void appendRecords(QVector<ConsoleRecord> records);
+
+		//Queued records are appended in one batch by appendPendingRecords
+		void queueRecord(const ConsoleRecord &record)						{ mPendingRecords.append(record); }
+		void appendPendingRecords();
+		bool hasPendingRecords() const										{ return !mPendingRecords.isEmpty(); }
+
+		void clear();
+		void clearExceptSeparators();
+
+		int rowCount(const QModelIndex &parent = QModelIndex()) const;
+		int columnCount(const QModelIndex &parent = QModelIndex()) const;
+		QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+		Qt::ItemFlags flags(const QModelIndex &index) const;
+
+	private:
+		const ConsoleRecord &record(int row) const							{ return mRecords.at((mFirst + row) % mRecords.size()); }
+		QString string(int index) const										{ return mStrings.value(index); }
+		void resetRecords(const QVector<ConsoleRecord> &records);
+
+		QVector<ConsoleRecord> mRecords;
+		QVector<ConsoleRecord> mPendingRecords;
+		int mFirst;//Index of the oldest record
+		int mCount;
+		int mCapacity;
+		QStringList mStrings;
+		QHash<QString, int> mStringIndexes;
+		QIcon mInformationIcon;
+		QIcon mWarningIcon;
+		QIcon mErrorIcon;
+		QFont mSeparatorFont;
+
+		Q_DISABLE_COPY(ConsoleModel)
+	};
+}
+
+#endif // CONSOLEMODEL_H
@@ -20,8 +20,6 @@
 
 #include "consoletableview.h"
 
-#include <QStandardItemModel>
-#include <QStandardItem>
 #include <QApplication>
 #include <QKeyEvent>
 #include <QClipboard>
@@ -37,13 +35,9 @@ namespace ActionTools
 	{
 		if(event->matches(QKeySequence::Copy))
 		{
-			QStandardItemModel *standardItemModel = qobject_cast<QStandardItemModel *>(model());
-			if(standardItemModel)
-			{
-				QStandardItem *item = standardItemModel->item(currentIndex().row(), 0);
-				if(item && !item->text().isEmpty())
-					QApplication::clipboard()->setText(item->text());
-			}
+			const QString &text = currentIndex().data().toString();
+			if(!text.isEmpty())
+				QApplication::clipboard()->setText(text);
 		}
 	}
 }
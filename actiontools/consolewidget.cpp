@@ -20,18 +20,21 @@
 
 #include "consolewidget.h"
 #include "ui_consolewidget.h"
-
-#include <QStandardItemModel>
+#include "consolemodel.h"
 
 namespace ActionTools
 {
 	ConsoleWidget::ConsoleWidget(QWidget *parent)
 		: QWidget(parent),
 		ui(new Ui::ConsoleWidget),
-		mModel(0)
+		mModel(0),
+		mFlushInterval(DefaultFlushInterval)
 	{
 		ui->setupUi(this);
 
+		mFlushTimer.setSingleShot(true);
+		connect(&mFlushTimer, SIGNAL(timeout()), this, SLOT(flush()));
+
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
         ui->console->verticalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
         ui->console->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
@@ -48,9 +51,9 @@ namespace ActionTools
 		delete ui;
 	}
 	
-	void ConsoleWidget::setup(QStandardItemModel *model)
+	void ConsoleWidget::setup(ConsoleModel *model)
 	{
-		mModel = (model ? model : new QStandardItemModel(0, 1, this));
+		mModel = (model ? model : new ConsoleModel(this));
 		
 		QItemSelectionModel *oldModel = ui->console->selectionModel();
 		ui->console->setModel(mModel);
@@ -61,74 +64,72 @@ namespace ActionTools
 
 	void ConsoleWidget::addScriptParameterLine(const QString &message, int parameter, int line, int column, Type type)
 	{
-		QStandardItem *item = new QStandardItem();
+		ConsoleRecord record;
 
-		item->setData(parameter, ParameterRole);
-		item->setData(line, LineRole);
-		item->setData(column, ColumnRole);
+		record.value = parameter;
+		record.line = line;
+		record.column = column;
 
-        addLine(message, item, Parameters, type);
+        addLine(message, record, Parameters, type);
     }
 
     void ConsoleWidget::addResourceLine(const QString &message, const QString &resourceKey, ConsoleWidget::Type type)
     {
-        QStandardItem *item = new QStandardItem();
+        ConsoleRecord record;
 
-        item->setData(resourceKey, ResourceRole);
+        record.value = mModel->internString(resourceKey);
 
-        addLine(message, item, Resources, type);
+        addLine(message, record, Resources, type);
     }
 
 	void ConsoleWidget::addActionLine(const QString &message, qint64 actionRuntimeId, const QString &field, const QString &subField, int line, int column, Type type)
 	{
-		QStandardItem *item = new QStandardItem();
+		ConsoleRecord record;
 
-		item->setData(actionRuntimeId, ActionRole);
-		item->setData(field, FieldRole);
-		item->setData(subField, SubFieldRole);
-		item->setData(line, LineRole);
-		item->setData(column, ColumnRole);
+		record.actionRuntimeId = actionRuntimeId;
+		record.field = mModel->internString(field);
+		record.subField = mModel->internString(subField);
+		record.line = line;
+		record.column = column;
 
-		addLine(message, item, Action, type);
+		addLine(message, record, Action, type);
 	}
 
 	void ConsoleWidget::addUserLine(const QString &message, qint64 actionRuntimeId, const QString &field, const QString &subField, int line, int column, const QStringList &backtrace, Type type)
 	{
-		QStandardItem *item = new QStandardItem();
+		ConsoleRecord record;
 
-		item->setData(actionRuntimeId, ActionRole);
-		item->setData(field, FieldRole);
-		item->setData(subField, SubFieldRole);
-		item->setData(line, LineRole);
-		item->setData(column, ColumnRole);
-		item->setData(backtrace, BacktraceRole);
+		record.actionRuntimeId = actionRuntimeId;
+		record.field = mModel->internString(field);
+		record.subField = mModel->internString(subField);
+		record.line = line;
+		record.column = column;
+		record.backtrace = backtrace;
 
-		addLine(message, item, User, type);
+		addLine(message, record, User, type);
 	}
 	
 	void ConsoleWidget::addExceptionLine(const QString &message, qint64 actionRuntimeId, int exception, Type type)
 	{
-		QStandardItem *item = new QStandardItem();
+		ConsoleRecord record;
 		
-		item->setData(actionRuntimeId, ActionRole);
-		item->setData(exception, ExceptionRole);
+		record.actionRuntimeId = actionRuntimeId;
+		record.value = exception;
 
-		addLine(message, item, Exception, type);
+		addLine(message, record, Exception, type);
 	}
 	
 	void ConsoleWidget::addDesignErrorLine(const QString &message, Type type)
 	{
-		QStandardItem *item = new QStandardItem();
+		ConsoleRecord record;
 
-		addLine(message, item, DesignError, type);
+		addLine(message, record, DesignError, type);
 	}
 
 	void ConsoleWidget::addStartSeparator()
 	{
 		mStartTime = QDateTime::currentDateTime();
-		QStandardItem *item = new QStandardItem(tr("Execution started at %1").arg(mStartTime.toString("dd/MM/yyyy hh:mm:ss:zzz")));
-		item->setTextAlignment(Qt::AlignCenter);
-		addSeparator(item);
+		addSeparator(tr("Execution started at %1").arg(mStartTime.toString("dd/MM/yyyy hh:mm:ss:zzz")));
 	}
 
 	void ConsoleWidget::addEndSeparator()
@@ -159,31 +160,23 @@ namespace ActionTools
 
 		durationString += tr("%n millisecond(s)", "", msec);
 
-		QStandardItem *item = new QStandardItem(tr("Execution ended at %1\n(%2)").arg(currentDateTime.toString("dd/MM/yyyy hh:mm:ss:zzz")).arg(durationString));
-		item->setTextAlignment(Qt::AlignCenter);
-		addSeparator(item);
+		addSeparator(tr("Execution ended at %1\n(%2)").arg(currentDateTime.toString("dd/MM/yyyy hh:mm:ss:zzz")).arg(durationString));
 	}
 
 	void ConsoleWidget::clear()
 	{
-		mModel->removeRows(0, mModel->rowCount());
+		mFlushTimer.stop();
+
+		mModel->clear();
 
         ui->clearPushButton->setEnabled(false);
     }
 
     void ConsoleWidget::clearExceptSeparators()
     {
-        int rowCount = mModel->rowCount();
-
-        for(int index = rowCount - 1; index >= 0; --index)
-        {
-            QStandardItem *item = mModel->item(index);
+        mFlushTimer.stop();
 
-            Type type = item->data(TypeRole).value<Type>();
-
-            if(type != Separator)
-                mModel->removeRow(index);
-        }
+        mModel->clearExceptSeparators();
 
         if(mModel->rowCount() == 0)
             ui->clearPushButton->setEnabled(false);
@@ -191,7 +184,16 @@ namespace ActionTools
 
 	void ConsoleWidget::updateClearButton()
 	{
-		ui->clearPushButton->setEnabled(mModel->rowCount() > 0);
+		ui->clearPushButton->setEnabled(mModel->rowCount() > 0 || mModel->hasPendingRecords());
+	}
+
+	void ConsoleWidget::flush()
+	{
+		mFlushTimer.stop();
+		mLastFlush.start();
+
+		//Inserting all the rows at once only triggers one view update
+		mModel->appendPendingRecords();
 	}
 
 	void ConsoleWidget::on_clearPushButton_clicked()
@@ -209,57 +211,40 @@ namespace ActionTools
 		emit itemClicked(index.row());
 	}
 	
-	void ConsoleWidget::addLine(const QString &message, QStandardItem *item, Source source, Type type)
+	void ConsoleWidget::addLine(const QString &message, ConsoleRecord &record, Source source, Type type)
 	{
-		QIcon icon;
+		Q_ASSERT(type != Separator && "Should use addSeparator instead");
 
-		switch(type)
-		{
-		case Information:
-			icon = QIcon(":/images/information.png");
-			break;
-		case Warning:
-			icon = QIcon(":/images/warning.png");
-			break;
-		case Error:
-			icon = QIcon(":/images/error.png");
-			break;
-        case Separator:
-            Q_ASSERT(false && "Should use addSeparator instead");
-            break;
-		}
+		record.message = message;
+		record.source = source;
+		record.type = type;
 
-		item->setText(message);
-		if(source == DesignError)
-			item->setToolTip(message);
-		else
-			item->setToolTip(message + tr("\nDouble-click to show"));
-		item->setIcon(icon);
-		item->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
-		item->setData(QVariant::fromValue<Source>(source), SourceRole);
-		item->setData(QVariant::fromValue<Type>(type), TypeRole);
+		mModel->queueRecord(record);
 
-		mModel->appendRow(item);
+		ui->clearPushButton->setEnabled(true);
 
-        qApp->processEvents(); // This is needed so that the console output gets displayed before a blocking call (such as sleep)
-        // It would be better not to have any blocking code calls, but then this would cause some bugs when the user cancels the execution during a non-blocking sleep
-        // Pausing the execution and then resuming it after some time seems to be the best way to do this, but would require important changes in the code
+		//Other lines are rare and flushed right away, so that they keep their order and are visible immediately
+		if(source != User || !mLastFlush.isValid() || mLastFlush.elapsed() >= mFlushInterval)
+		{
+			flush();
 
-		ui->clearPushButton->setEnabled(true);
+			qApp->processEvents(); // This is needed so that the console output gets displayed before a blocking call (such as sleep)
+			// It would be better not to have any blocking code calls, but then this would cause some bugs when the user cancels the execution during a non-blocking sleep
+			// Pausing the execution and then resuming it after some time seems to be the best way to do this, but would require important changes in the code
+		}
+		else if(!mFlushTimer.isActive())
+			mFlushTimer.start(mFlushInterval - static_cast<int>(mLastFlush.elapsed()));
 	}
 
-	void ConsoleWidget::addSeparator(QStandardItem *item)
+	void ConsoleWidget::addSeparator(const QString &message)
 	{
-		item->setFlags(0);
-		item->setBackground(QBrush(Qt::lightGray));
-                item->setForeground(QBrush(Qt::white));
+		ConsoleRecord record;
 
-		QFont appFont = QApplication::font();
-		appFont.setPointSize(7);
+		record.message = message;
+		record.type = Separator;
 
-		item->setFont(appFont);
-        item->setData(QVariant::fromValue<Type>(Separator), TypeRole);
+		flush();
 
-		mModel->appendRow(item);
+		mModel->appendRecord(record);
 	}
 }
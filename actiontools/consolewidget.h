@@ -26,17 +26,19 @@
 #include <QWidget>
 #include <QModelIndex>
 #include <QDateTime>
+#include <QTimer>
+#include <QElapsedTimer>
 
 namespace Ui
 {
 	class ConsoleWidget;
 }
 
-class QStandardItemModel;
-class QStandardItem;
-
 namespace ActionTools
 {
+	class ConsoleModel;
+	struct ConsoleRecord;
+
 	class ACTIONTOOLSSHARED_EXPORT ConsoleWidget : public QWidget
 	{
 		Q_OBJECT
@@ -76,7 +78,7 @@ namespace ActionTools
 		explicit ConsoleWidget(QWidget *parent = 0);
 		~ConsoleWidget();
 		
-		void setup(QStandardItemModel *model = 0);
+		void setup(ConsoleModel *model = 0);
 
 		void addScriptParameterLine(const QString &message, int parameter, int line, int column, Type type);
         void addResourceLine(const QString &message, const QString &resourceKey, Type type);
@@ -91,7 +93,14 @@ namespace ActionTools
 
 		void updateClearButton();
 
-		QStandardItemModel *model() const					{ return mModel; }
+		//User lines are queued and added to the model at most every flushInterval milliseconds
+		void setFlushInterval(int flushInterval)			{ mFlushInterval = flushInterval; }
+		int flushInterval() const							{ return mFlushInterval; }
+
+		ConsoleModel *model() const							{ return mModel; }
+
+	public slots:
+		void flush();
 
 	signals:
 		void itemDoubleClicked(int item);
@@ -103,12 +112,17 @@ namespace ActionTools
 		void on_console_clicked(const QModelIndex &index);
 
 	private:
-		void addLine(const QString &message, QStandardItem *item, Source source, Type type = Information);
-		void addSeparator(QStandardItem *item);
+		void addLine(const QString &message, ConsoleRecord &record, Source source, Type type = Information);
+		void addSeparator(const QString &message);
+
+		static const int DefaultFlushInterval = 100;
 
 		Ui::ConsoleWidget *ui;
-		QStandardItemModel *mModel;
+		ConsoleModel *mModel;
 		QDateTime mStartTime;
+		QTimer mFlushTimer;
+		QElapsedTimer mLastFlush;
+		int mFlushInterval;
 
 		Q_DISABLE_COPY(ConsoleWidget)
 	};
@@ -0,0 +1,124 @@
+/*
+	Actiona
+	Copyright (C) 2005-2017 Jonathan Mercier-Ganady
+
+	Actiona is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Actiona is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+	Contact : jmgr@jmgr.info
+*/
+
+#include "imagecache.h"
+
+#include <QFileInfo>
+#include <QMutexLocker>
+
+namespace ActionTools
+{
+	ImageCache &ImageCache::instance()
+	{
+		static ImageCache imageCache;
+
+		return imageCache;
+	}
+
+	ImageCache::ImageCache()
+		: mEntries(DefaultMaximumSize),
+		mHitCount(0),
+		mMissCount(0)
+	{
+	}
+
+	QImage ImageCache::load(const QString &filename)
+	{
+		QFileInfo fileInfo(filename);
+		QString canonicalFilePath = fileInfo.canonicalFilePath();
+
+		//Not a regular file (Qt resource, missing file): nothing to key the cache on
+		if(canonicalFilePath.isEmpty())
+			return QImage(filename);
+
+		QDateTime lastModified = fileInfo.lastModified();
+		qint64 fileSize = fileInfo.size();
+
+		{
+			QMutexLocker locker(&mMutex);
+
+			Entry *entry = mEntries.object(canonicalFilePath);
+			if(entry && entry->lastModified == lastModified && entry->fileSize == fileSize)
+			{
+				++mHitCount;
+
+				return entry->image;
+			}
+
+			++mMissCount;
+		}
+
+		//Decode without holding the lock
+		QImage image(canonicalFilePath);
+		if(image.isNull())
+			return image;
+
+		QMutexLocker locker(&mMutex);
+
+		//Images bigger than the maximum size are not inserted
+		mEntries.insert(canonicalFilePath, new Entry{image, lastModified, fileSize}, image.byteCount());
+
+		return image;
+	}
+
+	void ImageCache::setMaximumSize(int maximumSize)
+	{
+		QMutexLocker locker(&mMutex);
+
+		mEntries.setMaxCost(maximumSize);
+	}
+
+	int ImageCache::maximumSize() const
+	{
+		QMutexLocker locker(&mMutex);
+
+		return mEntries.maxCost();
+	}
+
+	int ImageCache::size() const
+	{
+		QMutexLocker locker(&mMutex);
+
+		return mEntries.totalCost();
+	}
+
+	quint64 ImageCache::hitCount() const
+	{
+		QMutexLocker locker(&mMutex);
+
+		return mHitCount;
+	}
+
+	quint64 ImageCache::missCount() const
+	{
+		QMutexLocker locker(&mMutex);
+
+		return mMissCount;
+	}
+
+	void ImageCache::clear()
+	{
+		QMutexLocker locker(&mMutex);
+
+		mEntries.clear();
+		mHitCount = 0;
+		mMissCount = 0;
+	}
+}
@@ -0,0 +1,74 @@
+/*
+	Actiona
+	Copyright (C) 2005-2017 Jonathan Mercier-Ganady
+
+	Actiona is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Actiona is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+	Contact : jmgr@jmgr.info
+*/
+
+#ifndef IMAGECACHE_H
+#define IMAGECACHE_H
+
+#include "actiontools_global.h"
+
+#include <QImage>
+#include <QCache>
+#include <QDateTime>
+#include <QMutex>
+
+namespace ActionTools
+{
+	//Process-wide cache of images decoded from files, so that an image used again (FindImage waiting, loops) is not decoded each time.
+	//Entries are keyed by canonical path and are reloaded if the file modification time or size changed.
+	class ACTIONTOOLSSHARED_EXPORT ImageCache
+	{
+	public:
+		static const int DefaultMaximumSize = 128 * 1024 * 1024;
+
+		static ImageCache &instance();
+
+		//Returns a null image if the file cannot be loaded
+		QImage load(const QString &filename);
+
+		//Maximum size of the cached images, in bytes: least recently used images are removed first
+		void setMaximumSize(int maximumSize);
+		int maximumSize() const;
+		int size() const;
+
+		quint64 hitCount() const;
+		quint64 missCount() const;
+
+		void clear();
+
+	private:
+		struct Entry
+		{
+			QImage image;
+			QDateTime lastModified;
+			qint64 fileSize;
+		};
+
+		ImageCache();
+
+		mutable QMutex mMutex;
+		QCache<QString, Entry> mEntries;
+		quint64 mHitCount;
+		quint64 mMissCount;
+
+		Q_DISABLE_COPY(ImageCache)
+	};
+}
+
+#endif // IMAGECACHE_H
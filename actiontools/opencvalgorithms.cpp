@@ -32,8 +32,94 @@
 #include <QtConcurrentRun>
 #endif
 
+#include <QThreadPool>
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThreadStorage>
+#include <QHash>
+#include <QSet>
+
+#include <algorithm>
+#include <vector>
+
 namespace ActionTools
 {
+    class OpenCVAlgorithms::TargetPyramid
+    {
+    public:
+        // the first level is the converted image, then each level is down sampled once more
+        QVector<cv::Mat> levels;
+    };
+
+    namespace
+    {
+        // searches done again with the same target image (waiting, loops) reuse its pyramid
+        struct TargetPyramidCache
+        {
+            static const int MaximumSize = 32 * 1024 * 1024;
+
+            TargetPyramidCache()
+                : entries(MaximumSize)
+            {
+            }
+
+            QMutex mutex;
+            QCache<QPair<qint64, int>, OpenCVAlgorithms::TargetPyramidPointer> entries;
+        };
+
+        TargetPyramidCache &targetPyramidCache()
+        {
+            static TargetPyramidCache cache;
+
+            return cache;
+        }
+
+        struct SourceBuffers
+        {
+            // down sampled levels of the source, the first one is half its size
+            QVector<cv::Mat> levels;
+            cv::Mat result;
+            cv::Mat localExtrema;
+        };
+
+        // each thread keeps the buffers of the last source sizes it searched
+        struct SearchBuffers
+        {
+            static const int MaximumSourceSizes = 8;
+
+            QHash<QPair<int, int>, SourceBuffers> sources;
+            cv::Mat searchResult;
+        };
+
+        struct Peak
+        {
+            float score;
+            int x;
+            int y;
+        };
+
+        // used both for the heap, where the worst peak is kept on top, and to sort the best peaks first;
+        //  ties are ordered by position so that the result does not depend on the heap order
+        bool isBetterPeak(const Peak &first, const Peak &second)
+        {
+            if(first.score != second.score)
+                return first.score > second.score;
+
+            if(first.y != second.y)
+                return first.y < second.y;
+
+            return first.x < second.x;
+        }
+
+        SearchBuffers &threadSearchBuffers()
+        {
+            static QThreadStorage<SearchBuffers> searchBuffers;
+
+            return searchBuffers.localData();
+        }
+    }
+
 	OpenCVAlgorithms::OpenCVAlgorithms(QObject *parent)
 		: QObject(parent),
 		  mError(NoError)
@@ -60,20 +146,23 @@ namespace ActionTools
 			return false;
 		}
 
+        if(!checkDownPyramidCount(downPyrs))
+            return false;
+
         QList<cv::Mat> sourcesMat;
         sourcesMat.reserve(sources.size());
 
         for(const QImage &source: sources)
             sourcesMat.append(toCVMat(source));
 
-        cv::Mat targetMat = toCVMat(target);
+        TargetPyramidPointer targetPyramid = OpenCVAlgorithms::targetPyramid(target, downPyrs);
 
-        if(!checkInputImages(sourcesMat, targetMat))
+        if(!checkInputImages(sourcesMat, targetPyramid->levels.first()))
 			return false;
 
         connect(&mFutureWatcher, SIGNAL(finished()), this, SLOT(finished()));
 
-        mFuture = QtConcurrent::run(boost::bind(&OpenCVAlgorithms::fastMatchTemplate, this, sourcesMat, targetMat, matchPercentage, maximumMatches, downPyrs, searchExpansion, method));
+        mFuture = QtConcurrent::run(boost::bind(&OpenCVAlgorithms::fastMatchTemplate, this, sourcesMat, targetPyramid, matchPercentage, maximumMatches, downPyrs, searchExpansion, method));
 		mFutureWatcher.setFuture(mFuture);
 
 		return true;
@@ -91,18 +180,21 @@ namespace ActionTools
 		mError = NoError;
 		mErrorString.clear();
 
+        if(!checkDownPyramidCount(downPyrs))
+            return false;
+
         QList<cv::Mat> sourcesMat;
         sourcesMat.reserve(sources.size());
 
         for(const QImage &source: sources)
             sourcesMat.append(toCVMat(source));
 
-        cv::Mat targetMat = toCVMat(target);
+        TargetPyramidPointer targetPyramid = OpenCVAlgorithms::targetPyramid(target, downPyrs);
 
-        if(!checkInputImages(sourcesMat, targetMat))
+        if(!checkInputImages(sourcesMat, targetPyramid->levels.first()))
 			return false;
 
-        matchingPoints = OpenCVAlgorithms::fastMatchTemplate(sourcesMat, targetMat, matchPercentage, maximumMatches, downPyrs, searchExpansion, method);
+        matchingPoints = OpenCVAlgorithms::fastMatchTemplate(sourcesMat, targetPyramid, matchPercentage, maximumMatches, downPyrs, searchExpansion, method);
 
         return true;
     }
@@ -152,229 +244,370 @@ namespace ActionTools
 		return true;
 	}
 
+    bool OpenCVAlgorithms::checkDownPyramidCount(int downPyrs)
+    {
+        // the pyramids are indexed by this count
+        if(downPyrs < 0)
+        {
+            mError = InvalidDownPyramidCountError;
+            mErrorString = tr("The down pyramid count cannot be negative");
+
+            return false;
+        }
+
+        return true;
+    }
+
     MatchingPointList OpenCVAlgorithms::fastMatchTemplate(const QList<cv::Mat> &sources,
-                                                                            const cv::Mat &target,
+                                                                            const TargetPyramidPointer &targetPyramid,
 																			int matchPercentage,
 																			int maximumMatches,
 																			int downPyrs,
                                                                             int searchExpansion,
                                                                             AlgorithmMethod method)
 	{
+        QVector<MatchingPointList> sourceMatchingPoints(sources.size());
+        QVector<QString> sourceErrors(sources.size());
+
+        // each source is searched in its own task, the first one in this thread
+        QList<QFuture<void>> futures;
+        for(int sourceIndex = 1; sourceIndex < sources.size(); ++sourceIndex)
+        {
+            auto task = [&, sourceIndex]
+            {
+                sourceMatchingPoints[sourceIndex] = matchSource(sources.at(sourceIndex), *targetPyramid, sourceIndex, matchPercentage, maximumMatches, downPyrs, searchExpansion, method, sourceErrors[sourceIndex]);
+            };
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 4, 0))
+            futures.append(QtConcurrent::run(matchingThreadPool(), task));
+#else
+            futures.append(QtConcurrent::run(task));
+#endif
+        }
+
+        if(!sources.isEmpty())
+            sourceMatchingPoints[0] = matchSource(sources.first(), *targetPyramid, 0, matchPercentage, maximumMatches, downPyrs, searchExpansion, method, sourceErrors[0]);
+
+        for(QFuture<void> &future: futures)
+            future.waitForFinished();
+
+        // merge in source order so that the result does not depend on scheduling
         MatchingPointList matchingPointList;
-        int sourceIndex = 0;
 
-        for(const cv::Mat &source: sources)
+        for(int sourceIndex = 0; sourceIndex < sources.size(); ++sourceIndex)
         {
-            try
+            if(!sourceErrors.at(sourceIndex).isEmpty())
             {
-                // create copies of the images to modify
-                cv::Mat copyOfSource = source.clone();
-                cv::Mat copyOfTarget = target.clone();
+                mError = OpenCVException;
+                mErrorString = tr("OpenCV exception: %1").arg(sourceErrors.at(sourceIndex));
 
-                cv::Size sourceSize = source.size();
-                cv::Size targetSize = target.size();
+                return MatchingPointList();
+            }
 
-                // down pyramid the images
-                for(int ii = 0; ii < downPyrs; ii++)
-                {
-                    // start with the source image
-                    sourceSize.width  = (sourceSize.width  + 1) / 2;
-                    sourceSize.height = (sourceSize.height + 1) / 2;
+            matchingPointList.append(sourceMatchingPoints.at(sourceIndex));
+        }
+
+		return matchingPointList;
+	}
+
+    MatchingPointList OpenCVAlgorithms::matchSource(const cv::Mat &source,
+                                                    const TargetPyramid &targetPyramid,
+                                                    int sourceIndex,
+                                                    int matchPercentage,
+                                                    int maximumMatches,
+                                                    int downPyrs,
+                                                    int searchExpansion,
+                                                    AlgorithmMethod method,
+                                                    QString &error)
+    {
+        MatchingPointList matchingPointList;
+        const cv::Mat &target = targetPyramid.levels.first();
+
+        try
+        {
+            // the target is already down sampled
+            const cv::Mat &smallTarget = targetPyramid.levels.at(downPyrs);
+
+            // the source levels and the results are written in the buffers of this thread,
+            //  that are only allocated the first time a source of this size is searched
+            SearchBuffers &searchBuffers = threadSearchBuffers();
+            QPair<int, int> sourceSizeKey(source.cols, source.rows);
+
+            if(!searchBuffers.sources.contains(sourceSizeKey) && searchBuffers.sources.size() >= SearchBuffers::MaximumSourceSizes)
+                searchBuffers.sources.clear();
+
+            SourceBuffers &sourceBuffers = searchBuffers.sources[sourceSizeKey];
+            sourceBuffers.levels.resize(downPyrs);
+
+            // down pyramid the source, the first level is read from the source itself
+            const cv::Mat *smallSource = &source;
+            for(int level = 0; level < downPyrs; ++level)
+            {
+                cv::pyrDown(*smallSource, sourceBuffers.levels[level]);
+
+                smallSource = &sourceBuffers.levels.at(level);
+            }
 
-                    cv::Mat smallSource(sourceSize, source.type());
-                    cv::pyrDown(copyOfSource, smallSource);
+            // perform the match on the shrunken images
+            cv::Mat &result = sourceBuffers.result;
+            cv::matchTemplate(*smallSource, smallTarget, result, toOpenCVMethod(method));
 
-                    // prepare for next loop, if any
-                    copyOfSource = smallSource.clone();
+            // find the top match locations, at most one per template-sized area
+            QVector<QPoint> locations = findPeaks(result, maximumMatches, QSize(smallTarget.cols, smallTarget.rows), method, sourceBuffers.localExtrema);
 
-                    // next, do the target
-                    targetSize.width  = (targetSize.width  + 1) / 2;
-                    targetSize.height = (targetSize.height + 1) / 2;
+            // search the large images at the returned locations
+            cv::Size sourceSize = source.size();
+            cv::Size targetSize = target.size();
 
-                    cv::Mat smallTarget(targetSize, target.type());
-                    pyrDown(copyOfTarget, smallTarget);
+            int twoPowerNumDownPyrs = std::pow(2.0f, downPyrs);
 
-                    // prepare for next loop, if any
-                    copyOfTarget = smallTarget.clone();
+            // refined locations already found, two peaks can lead to the same one
+            QSet<QPair<int, int>> foundLocations;
+
+            for(int currMax = 0; currMax < locations.size(); ++currMax)
+            {
+                // transform the point to its corresponding point in the larger image
+                QPoint &currMaxLocation = locations[currMax];
+                currMaxLocation *= twoPowerNumDownPyrs;
+                currMaxLocation.setX(currMaxLocation.x() + targetSize.width / 2);
+                currMaxLocation.setY(currMaxLocation.y() + targetSize.height / 2);
+
+                const QPoint &searchPoint = locations.at(currMax);
+
+                // set the source image's ROI to slightly larger than the target image,
+                //  centred at the current point
+                cv::Rect searchRoi;
+                searchRoi.x = searchPoint.x() - (target.size().width) / 2 - searchExpansion;
+                searchRoi.y = searchPoint.y() - (target.size().height) / 2 - searchExpansion;
+                searchRoi.width = target.size().width + searchExpansion * 2;
+                searchRoi.height = target.size().height + searchExpansion * 2;
+
+                // make sure ROI doesn't extend outside of image
+                if(searchRoi.x < 0)
+                    searchRoi.x = 0;
+
+                if(searchRoi.y < 0)
+                    searchRoi.y = 0;
+
+                if((searchRoi.x + searchRoi.width) > (sourceSize.width - 1))
+                {
+                    int numPixelsOver = (searchRoi.x + searchRoi.width) - (sourceSize.width - 1);
+
+                    searchRoi.width -= numPixelsOver;
                 }
 
-                // perform the match on the shrunken images
-                cv::Size smallTargetSize = copyOfTarget.size();
-                cv::Size smallSourceSize = copyOfSource.size();
+                if((searchRoi.y + searchRoi.height) > (sourceSize.height - 1))
+                {
+                    int numPixelsOver = (searchRoi.y + searchRoi.height) - (sourceSize.height - 1);
+
+                    searchRoi.height -= numPixelsOver;
+                }
+
+                cv::Mat searchImage(source, searchRoi);
+
+                // perform the search on the large images
+                cv::Mat &searchResult = searchBuffers.searchResult;
+                cv::matchTemplate(searchImage, target, searchResult, toOpenCVMethod(method));
 
-                cv::Size resultSize;
-                resultSize.width = smallSourceSize.width - smallTargetSize.width + 1;
-                resultSize.height = smallSourceSize.height - smallTargetSize.height + 1;
+                // find the best match location
+                double minValue;
+                double maxValue;
+                cv::Point minLoc;
+                cv::Point maxLoc;
 
-                cv::Mat result(resultSize, CV_32FC1);
-                cv::matchTemplate(copyOfSource, copyOfTarget, result, toOpenCVMethod(method));
+                cv::minMaxLoc(searchResult, &minValue, &maxValue, &minLoc, &maxLoc);
 
-                // find the top match locations
-                QVector<QPoint> locations = multipleMinMaxLoc(result, maximumMatches, method);
+                double &value = (method == SquaredDifferenceMethod) ? minValue : maxValue;
+                cv::Point &loc = (method == SquaredDifferenceMethod) ? minLoc : maxLoc;
 
-                // search the large images at the returned locations
-                sourceSize = source.size();
-                targetSize = target.size();
+                value *= 100.0;
 
-                int twoPowerNumDownPyrs = std::pow(2.0f, downPyrs);
+                // transform point back to original image
+                loc.x += searchRoi.x + target.size().width / 2;
+                loc.y += searchRoi.y + target.size().height / 2;
 
-                // create a copy of the source in order to adjust its ROI for searching
-                for(int currMax = 0; currMax < maximumMatches; ++currMax)
+                if(method == SquaredDifferenceMethod)
+                    value = 100.0f - value;
+
+                if(value >= matchPercentage)
                 {
-                    // transform the point to its corresponding point in the larger image
-                    QPoint &currMaxLocation = locations[currMax];
-                    currMaxLocation *= twoPowerNumDownPyrs;
-                    currMaxLocation.setX(currMaxLocation.x() + targetSize.width / 2);
-                    currMaxLocation.setY(currMaxLocation.y() + targetSize.height / 2);
+                    if(foundLocations.contains(qMakePair(loc.x, loc.y)))
+                        continue;
 
-                    const QPoint &searchPoint = locations.at(currMax);
+                    foundLocations.insert(qMakePair(loc.x, loc.y));
 
-                    // if we are searching for multiple targets and we have found a target or
-                    //  multiple targets, we don't want to search in the same location(s) again
-                    if(maximumMatches > 1 && !matchingPointList.isEmpty())
-                    {
-                        bool thisTargetFound = false;
+                    // add the point to the list
+                    matchingPointList.append(MatchingPoint(QPoint(loc.x, loc.y), value, sourceIndex));
 
-                        for(int currPoint = 0; currPoint < matchingPointList.size(); currPoint++)
-                        {
-                            const QPoint &foundPoint = matchingPointList.at(currPoint).position;
-                            if(std::abs(searchPoint.x() - foundPoint.x()) <= searchExpansion * 2 &&
-                               std::abs(searchPoint.y() - foundPoint.y()) <= searchExpansion * 2)
-                            {
-                                thisTargetFound = true;
-                                break;
-                            }
-                        }
+                    // if we are only looking for a single target, we have found it, so we
+                    //  can return
+                    if(maximumMatches <= 1)
+                        break;
+                }
+                else
+                    break; // skip the rest
+            }
+        }
+        catch(const cv::Exception &e)
+        {
+            error = QString::fromLocal8Bit(e.what());
 
-                        // if the current target has been found, continue onto the next point
-                        if(thisTargetFound)
-                            continue;
-                    }
+            return MatchingPointList();
+        }
 
-                    // set the source image's ROI to slightly larger than the target image,
-                    //  centred at the current point
-                    cv::Rect searchRoi;
-                    searchRoi.x = searchPoint.x() - (target.size().width) / 2 - searchExpansion;
-                    searchRoi.y = searchPoint.y() - (target.size().height) / 2 - searchExpansion;
-                    searchRoi.width = target.size().width + searchExpansion * 2;
-                    searchRoi.height = target.size().height + searchExpansion * 2;
+        return matchingPointList;
+    }
 
-                    // make sure ROI doesn't extend outside of image
-                    if(searchRoi.x < 0)
-                        searchRoi.x = 0;
+    OpenCVAlgorithms::TargetPyramidPointer OpenCVAlgorithms::targetPyramid(const QImage &target, int downPyrs)
+    {
+        TargetPyramidCache &cache = targetPyramidCache();
+        QPair<qint64, int> key(target.cacheKey(), downPyrs);
 
-                    if(searchRoi.y < 0)
-                        searchRoi.y = 0;
+        {
+            QMutexLocker locker(&cache.mutex);
 
-                    if((searchRoi.x + searchRoi.width) > (sourceSize.width - 1))
-                    {
-                        int numPixelsOver = (searchRoi.x + searchRoi.width) - (sourceSize.width - 1);
+            if(TargetPyramidPointer *targetPyramid = cache.entries.object(key))
+                return *targetPyramid;
+        }
 
-                        searchRoi.width -= numPixelsOver;
-                    }
+        // convert and down sample without holding the lock
+        QSharedPointer<TargetPyramid> targetPyramid(new TargetPyramid);
+        targetPyramid->levels.reserve(downPyrs + 1);
+        targetPyramid->levels.append(toCVMat(target));
 
-                    if((searchRoi.y + searchRoi.height) > (sourceSize.height - 1))
-                    {
-                        int numPixelsOver = (searchRoi.y + searchRoi.height) - (sourceSize.height - 1);
+        int size = static_cast<int>(targetPyramid->levels.last().total() * targetPyramid->levels.last().elemSize());
 
-                        searchRoi.height -= numPixelsOver;
-                    }
+        for(int level = 0; level < downPyrs; ++level)
+        {
+            cv::Mat smallTarget;
+            cv::pyrDown(targetPyramid->levels.last(), smallTarget);
+
+            size += static_cast<int>(smallTarget.total() * smallTarget.elemSize());
+            targetPyramid->levels.append(smallTarget);
+        }
+
+        // a null image has no unique cache key
+        if(!target.isNull())
+        {
+            QMutexLocker locker(&cache.mutex);
+
+            cache.entries.insert(key, new TargetPyramidPointer(targetPyramid), size);
+        }
+
+        return targetPyramid;
+    }
 
-                    cv::Mat searchImage(source, searchRoi);
+    QThreadPool *OpenCVAlgorithms::matchingThreadPool()
+    {
+        // not the global pool, the searches themselves run in it
+        static QThreadPool threadPool;
 
-                    // perform the search on the large images
-                    resultSize.width = searchRoi.width - target.size().width + 1;
-                    resultSize.height = searchRoi.height - target.size().height + 1;
+        return &threadPool;
+    }
 
-                    result = cv::Mat(resultSize, CV_32FC1);
-                    cv::matchTemplate(searchImage, target, result, toOpenCVMethod(method));
+    QVector<QPoint> OpenCVAlgorithms::findPeaks(const cv::Mat &image, int maximumMatches, const QSize &templateSize, AlgorithmMethod method, cv::Mat &localExtrema)
+	{
+        if(maximumMatches < 1)
+            return QVector<QPoint>();
+
+        // scores are negated for the squared difference, so that higher is always better
+        bool lowerIsBetter = (method == SquaredDifferenceMethod);
+
+        // require at least 50% confidence on the sub-sampled image
+        // in order to make this as fast as possible
+        float minimumScore = lowerIsBetter ? -0.5f : 0.5f;
+
+        // only the extremum of its 3x3 neighbourhood can be a peak, so that a wide
+        //  maximum does not fill the candidates with its neighbouring pixels
+        if(lowerIsBetter)
+            cv::erode(image, localExtrema, cv::Mat());
+        else
+            cv::dilate(image, localExtrema, cv::Mat());
+
+        // bounded min-heap of the best candidates, some more than needed since
+        //  overlapping ones are removed afterwards
+        int capacity = static_cast<int>(qMin<qint64>(static_cast<qint64>(maximumMatches) * 4, image.total()));
+        std::vector<Peak> candidates;
+        candidates.reserve(capacity + 1);
+
+        for(int y = 0; y < image.rows; ++y)
+        {
+            // skip the rows that have no pixel above the current minimum, minMaxLoc is vectorized
+            double rowMinimum;
+            double rowMaximum;
+            cv::minMaxLoc(image.row(y), &rowMinimum, &rowMaximum);
 
-                    // find the best match location
-                    double minValue;
-                    double maxValue;
-                    cv::Point minLoc;
-                    cv::Point maxLoc;
+            if((lowerIsBetter ? -rowMinimum : rowMaximum) <= minimumScore)
+                continue;
 
-                    cv::minMaxLoc(result, &minValue, &maxValue, &minLoc, &maxLoc);
+            const float *row = image.ptr<float>(y);
+            const float *extremaRow = localExtrema.ptr<float>(y);
 
-                    double &value = (method == SquaredDifferenceMethod) ? minValue : maxValue;
-                    cv::Point &loc = (method == SquaredDifferenceMethod) ? minLoc : maxLoc;
+            for(int x = 0; x < image.cols; ++x)
+            {
+                float score = lowerIsBetter ? -row[x] : row[x];
 
-                    value *= 100.0;
+                if(score <= minimumScore || row[x] != extremaRow[x])
+                    continue;
 
-                    // transform point back to original image
-                    loc.x += searchRoi.x + target.size().width / 2;
-                    loc.y += searchRoi.y + target.size().height / 2;
+                candidates.push_back(Peak{score, x, y});
+                std::push_heap(candidates.begin(), candidates.end(), isBetterPeak);
 
-                    if(method == SquaredDifferenceMethod)
-                        value = 100.0f - value;
+                if(static_cast<int>(candidates.size()) > capacity)
+                {
+                    std::pop_heap(candidates.begin(), candidates.end(), isBetterPeak);
+                    candidates.pop_back();
+                }
 
-                    if(value >= matchPercentage)
-                    {
-                        // add the point to the list
-                        matchingPointList.append(MatchingPoint(QPoint(loc.x, loc.y), value, sourceIndex));
+                if(static_cast<int>(candidates.size()) == capacity)
+                    minimumScore = candidates.front().score;
+            }
+        }
+
+        std::sort(candidates.begin(), candidates.end(), isBetterPeak);
+
+        // non-maximum suppression: a candidate overlapping a better one by a template size is dropped,
+        //  the kept ones are stored in a grid of template-sized cells so that only 9 cells are checked
+        QVector<QPoint> locations;
+        locations.reserve(qMin(maximumMatches, capacity));
+
+        int cellWidth = qMax(1, templateSize.width());
+        int cellHeight = qMax(1, templateSize.height());
+        QHash<QPair<int, int>, QVector<QPoint>> grid;
 
-                        // if we are only looking for a single target, we have found it, so we
-                        //  can return
-                        if(maximumMatches <= 1)
+        for(const Peak &candidate: candidates)
+        {
+            if(locations.size() >= maximumMatches)
+                break;
+
+            int cellX = candidate.x / cellWidth;
+            int cellY = candidate.y / cellHeight;
+            bool overlaps = false;
+
+            for(int neighbourY = cellY - 1; neighbourY <= cellY + 1 && !overlaps; ++neighbourY)
+            {
+                for(int neighbourX = cellX - 1; neighbourX <= cellX + 1 && !overlaps; ++neighbourX)
+                {
+                    for(const QPoint &location: grid.value(qMakePair(neighbourX, neighbourY)))
+                    {
+                        if(std::abs(candidate.x - location.x()) < cellWidth &&
+                           std::abs(candidate.y - location.y()) < cellHeight)
+                        {
+                            overlaps = true;
                             break;
+                        }
                     }
-                    else
-                        break; // skip the rest
                 }
             }
-            catch(const cv::Exception &e)
-            {
-                mError = OpenCVException;
-                mErrorString = tr("OpenCV exception: %1").arg(e.what());
 
-                return MatchingPointList();
-            }
+            if(overlaps)
+                continue;
 
-            ++sourceIndex;
-        }
+            QPoint location(candidate.x, candidate.y);
 
-		return matchingPointList;
-	}
-
-    QVector<QPoint> OpenCVAlgorithms::multipleMinMaxLoc(const cv::Mat &image, int maximumMatches, AlgorithmMethod method)
-	{
-		QVector<QPoint> locations(maximumMatches);
-        QVector<float> matches(maximumMatches, (method == SquaredDifferenceMethod) ? std::numeric_limits<float>::max() : -std::numeric_limits<float>::max());
-		cv::Size size = image.size();
-
-		// extract the raw data for analysis
-		for(int y = 0; y < size.height; ++y)
-		{
-			for(int x = 0; x < size.width; ++x)
-			{
-				float data = image.at<float>(y, x);
-
-				// insert the data value into the array if it is greater than any of the
-				//  other array values, and bump the other values below it, down
-				for(int j = 0; j < maximumMatches; ++j)
-				{
-					// require at least 50% confidence on the sub-sampled image
-					// in order to make this as fast as possible
-                    if((method == SquaredDifferenceMethod && data < 0.5f && data < matches.at(j)) ||
-                       (method != SquaredDifferenceMethod && data > 0.5f && data > matches.at(j)))
-					{
-						// move the maxima down
-						for(int k = maximumMatches - 1; k > j; --k)
-						{
-                            matches[k] = matches.at(k-1);
-							locations[k] = locations.at(k-1);
-						}
-
-						// insert the value
-                        matches[j] = data;
-						locations[j].setX(x);
-						locations[j].setY(y);
-						break;
-					}
-				}
-			}
-		}
+            grid[qMakePair(cellX, cellY)].append(location);
+            locations.append(location);
+        }
 
 		return locations;
 	}
@@ -75,6 +75,9 @@
 #include <QFuture>
 #include <QFutureWatcher>
 #include <QMetaType>
+#include <QSharedPointer>
+
+class QThreadPool;
 
 namespace cv
 {
@@ -95,7 +98,8 @@ namespace ActionTools
 			SourceImageSmallerThanTargerImageError,
 			NotSameDepthError,
 			NotSameChannelCountError,
-			OpenCVException
+			OpenCVException,
+			InvalidDownPyramidCountError
 		};
 
         enum AlgorithmMethod
@@ -105,6 +109,10 @@ namespace ActionTools
             SquaredDifferenceMethod
         };
 
+        // Target image converted to OpenCV and down sampled, shared between searches
+        class TargetPyramid;
+        using TargetPyramidPointer = QSharedPointer<const TargetPyramid>;
+
 		explicit OpenCVAlgorithms(QObject *parent = 0);
 
         bool findSubImageAsync(const QList<QImage> &sources,
@@ -124,6 +132,9 @@ namespace ActionTools
                           AlgorithmMethod method = CorrelationCoefficientMethod);
         void cancelSearch();
 
+        // Returns the pyramid of the target image, from a process-wide cache keyed by QImage::cacheKey()
+        static TargetPyramidPointer targetPyramid(const QImage &target, int downPyrs);
+
 		AlgorithmError error() const { return mError; }
 		const QString &errorString() const { return mErrorString; }
 
@@ -135,6 +146,7 @@ namespace ActionTools
 
 	private:
         bool checkInputImages(const QList<cv::Mat> &sources, const cv::Mat &target);
+        bool checkDownPyramidCount(int downPyrs);
 
 		/*=============================================================================
 		  FastMatchTemplate
@@ -159,14 +171,28 @@ namespace ActionTools
 							  directions
 		*/
         MatchingPointList fastMatchTemplate(const QList<cv::Mat> &sources,
-                                            const cv::Mat &target,
+                                            const TargetPyramidPointer &targetPyramid,
                                             int matchPercentage,
                                             int maximumMatches,
                                             int downPyrs,
                                             int searchExpansion,
                                             AlgorithmMethod method);
-
-        static QVector<QPoint> multipleMinMaxLoc(const cv::Mat &image, int maximumMatches, AlgorithmMethod method);
+        // Searches one source image, sets error and returns no point if OpenCV throws
+        static MatchingPointList matchSource(const cv::Mat &source,
+                                             const TargetPyramid &targetPyramid,
+                                             int sourceIndex,
+                                             int matchPercentage,
+                                             int maximumMatches,
+                                             int downPyrs,
+                                             int searchExpansion,
+                                             AlgorithmMethod method,
+                                             QString &error);
+        // Bounded pool used to search the sources concurrently
+        static QThreadPool *matchingThreadPool();
+
+        // Returns the best locations of a match result, best first, at most one per template-sized area.
+        // localExtrema is a buffer reused between calls.
+        static QVector<QPoint> findPeaks(const cv::Mat &image, int maximumMatches, const QSize &templateSize, AlgorithmMethod method, cv::Mat &localExtrema);
 
         static QImage toQImage(const cv::Mat &image);
         static cv::Mat toCVMat(const QImage &image);
@@ -26,4 +26,26 @@ namespace ActionTools
             << QT_TRANSLATE_NOOP("Resource::typeNames", "Binary")
             << QT_TRANSLATE_NOOP("Resource::typeNames", "Text")
             << QT_TRANSLATE_NOOP("Resource::typeNames", "Image");
+
+    const QByteArray &Resource::data() const
+    {
+        if(d->source)
+        {
+            d->data = d->source->read();
+            d->source.clear();
+        }
+
+        return d->data;
+    }
+
+    const QImage &Resource::image() const
+    {
+        if(!d->imageDecoded)
+        {
+            d->image.loadFromData(data());
+            d->imageDecoded = true;
+        }
+
+        return d->image;
+    }
 }
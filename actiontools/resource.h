@@ -24,22 +24,42 @@
 #include "actiontools_global.h"
 
 #include <QSharedData>
+#include <QSharedPointer>
 #include <QByteArray>
 #include <QStringList>
+#include <QImage>
 
 namespace ActionTools
 {
+    //Where the data of a resource that has not been used yet can be read from
+    class ACTIONTOOLSSHARED_EXPORT ResourceSource
+    {
+    public:
+        virtual ~ResourceSource()               {}
+
+        virtual QByteArray read() const = 0;
+    };
+
     class ResourceData : public QSharedData
     {
     public:
-        ResourceData() : type(0)                {}
+        ResourceData() : type(0), imageDecoded(false)   {}
         ResourceData(const ResourceData &other) :
             QSharedData(other),
             data(other.data),
-            type(other.type)					{}
-
-        QByteArray data;
+            source(other.source),
+            type(other.type),
+            image(other.image),
+            imageDecoded(other.imageDecoded)    {}
+
+        //Read from the source when first used
+        mutable QByteArray data;
+        mutable QSharedPointer<const ResourceSource> source;
         int type;
+
+        //Decoded image, cached by the resource and its copies until the data changes
+        mutable QImage image;
+        mutable bool imageDecoded;
     };
 
     class ACTIONTOOLSSHARED_EXPORT Resource
@@ -64,13 +84,22 @@ namespace ActionTools
             setData(data);
             setType(type);
         }
+        Resource(const QSharedPointer<const ResourceSource> &source, Type type)
+            : d(new ResourceData())
+        {
+            d->source = source;
+            setType(type);
+        }
         Resource(const Resource &other)
             : d(other.d)						{}
 
-        const QByteArray &data() const          { return d->data; }
+        const QByteArray &data() const;
         Type type() const                       { return static_cast<Type>(d->type); }
 
-        void setData(const QByteArray &data)    { d->data = data; }
+        //Decodes the data on first use only, returns a null image if it is not a valid image
+        const QImage &image() const;
+
+        void setData(const QByteArray &data)    { d->data = data; d->source.clear(); d->image = QImage(); d->imageDecoded = false; }
         void setType(Type type)                 { d->type = type; }
 
         static QStringList typeNames;
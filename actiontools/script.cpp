@@ -35,6 +35,288 @@
 #include <QXmlSchema>
 #include <QXmlSchemaValidator>
 #include <QBuffer>
+#include <QtEndian>
+#include <QVector>
+#include <QPair>
+#include <QFuture>
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
+#include <QtConcurrent/QtConcurrentRun>
+#else
+#include <QtConcurrentRun>
+#endif
+
+#include <limits>
+
+namespace
+{
+    //Schemas are compiled once per process, returns 0 if the schema could not be loaded
+    const QXmlSchema *compiledSchema(const Tools::Version &scriptVersion)
+    {
+        static QHash<QString, QXmlSchema> schemas;
+
+        QString schemaName = QString(":/script%1.xsd").arg(scriptVersion.toString());
+        auto schemaIt = schemas.find(schemaName);
+        if(schemaIt == schemas.end())
+        {
+#ifdef ACT_PROFILE
+            Tools::HighResolutionTimer timer("loading schema file");
+#endif
+            QXmlSchema schema;
+            QFile schemaFile(schemaName);
+            if(schemaFile.open(QIODevice::ReadOnly))
+                schema.load(&schemaFile);
+
+            schemaIt = schemas.insert(schemaName, schema);
+        }
+
+        if(!schemaIt.value().isValid())
+            return 0;
+
+        return &schemaIt.value();
+    }
+
+    //Binary scripts (.ascb) are made of little-endian 32 bits words: a header, then sections of fixed size records
+    //(strings, action definitions, parameters, resources, actions, sub-parameters, exceptions), the UTF-8 string data
+    //and the raw resource data, each resource being aligned on 16 bytes
+    const quint32 BinaryScriptMagic = 0x42435341; //"ASCB"
+    const quint32 BinaryScriptFormatVersion = 1;
+    const quint32 BinaryHeaderWords = 16;
+    const quint32 BinaryStringWords = 2;
+    const quint32 BinaryDefinitionWords = 2;
+    const quint32 BinaryParameterWords = 4;
+    const quint32 BinaryResourceWords = 6;
+    const quint32 BinaryActionWords = 12;
+    const quint32 BinarySubParameterWords = 4;
+    const quint32 BinaryExceptionWords = 3;
+    const quint32 BinaryActionEnabled = 1 << 0;
+    const quint32 BinaryActionHasColor = 1 << 1;
+
+    quint64 binaryAlign(quint64 offset)
+    {
+        return (offset + 15) & ~static_cast<quint64>(15);
+    }
+
+    void appendBinaryWord(QByteArray &buffer, quint32 value)
+    {
+        value = qToLittleEndian(value);
+        buffer.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    class BinaryStringTable
+    {
+    public:
+        quint32 index(const QString &string)
+        {
+            auto indexIt = mIndexes.constFind(string);
+            if(indexIt != mIndexes.constEnd())
+                return indexIt.value();
+
+            quint32 index = mStrings.size();
+            mStrings.append(string);
+            mIndexes.insert(string, index);
+
+            return index;
+        }
+
+        const QStringList &strings() const  { return mStrings; }
+
+    private:
+        QHash<QString, quint32> mIndexes;
+        QStringList mStrings;
+    };
+
+    //Content of a script file, mapped in memory when possible, kept while unused resources point into it
+    class BinaryScriptStorage
+    {
+    public:
+        explicit BinaryScriptStorage(QIODevice *device)
+            : mData(0),
+            mSize(0)
+        {
+            QFile *file = qobject_cast<QFile *>(device);
+            if(file && !file->fileName().isEmpty())
+            {
+                mFile.setFileName(file->fileName());
+                if(mFile.open(QIODevice::ReadOnly))
+                {
+                    mSize = mFile.size();
+                    mData = mFile.map(0, mSize);
+                    if(mData)
+                        return;
+                }
+            }
+
+            mBuffer = device->readAll();
+            mData = reinterpret_cast<const uchar *>(mBuffer.constData());
+            mSize = mBuffer.size();
+        }
+
+        const uchar *data() const           { return mData; }
+        qint64 size() const                 { return mSize; }
+
+    private:
+        QFile mFile;
+        QByteArray mBuffer;
+        const uchar *mData;
+        qint64 mSize;
+
+        Q_DISABLE_COPY(BinaryScriptStorage)
+    };
+
+    class BinaryResourceSource : public ActionTools::ResourceSource
+    {
+    public:
+        BinaryResourceSource(const QSharedPointer<BinaryScriptStorage> &storage, qint64 offset, int size)
+            : mStorage(storage),
+            mOffset(offset),
+            mSize(size)
+        {
+        }
+
+        QByteArray read() const
+        {
+            return QByteArray(reinterpret_cast<const char *>(mStorage->data() + mOffset), mSize);
+        }
+
+    private:
+        QSharedPointer<BinaryScriptStorage> mStorage;
+        qint64 mOffset;
+        int mSize;
+    };
+
+    //Resources can also be stored after the XML content of a script, split in compressed blocks. The section ends with
+    //the index offset, the XML content size, a format version and a magic number, so that it can be found from the end
+    //of the file.
+    const quint32 AppendedResourcesMagic = 0x53525341; //"ASRS"
+    const quint32 AppendedResourcesFormatVersion = 1;
+    const int AppendedResourcesTrailerSize = 24;
+    const int AppendedResourceBlockSize = 1024 * 1024;
+    const int Base64PartSize = 3 * 16 * 1024;
+
+    QByteArray uncompressResourceBlock(const uchar *data, int size)
+    {
+        return qUncompress(data, size);
+    }
+
+    class AppendedResourceSource : public ActionTools::ResourceSource
+    {
+    public:
+        AppendedResourceSource(const QSharedPointer<BinaryScriptStorage> &storage, const QVector<QPair<qint64, int>> &blocks, int size)
+            : mStorage(storage),
+            mBlocks(blocks),
+            mSize(size)
+        {
+        }
+
+        //Blocks are decompressed in parallel
+        QByteArray read() const
+        {
+            QList<QFuture<QByteArray>> futures;
+            for(int blockIndex = 1; blockIndex < mBlocks.size(); ++blockIndex)
+                futures.append(QtConcurrent::run(uncompressResourceBlock, mStorage->data() + mBlocks.at(blockIndex).first, mBlocks.at(blockIndex).second));
+
+            QByteArray result;
+            result.reserve(mSize);
+
+            if(!mBlocks.isEmpty())
+                result.append(uncompressResourceBlock(mStorage->data() + mBlocks.first().first, mBlocks.first().second));
+
+            for(const QFuture<QByteArray> &future: futures)
+                result.append(future.result());
+
+            return result;
+        }
+
+    private:
+        QSharedPointer<BinaryScriptStorage> mStorage;
+        QVector<QPair<qint64, int>> mBlocks;
+        int mSize;
+    };
+
+    //Returns a null storage if there are no resources after the XML content
+    QSharedPointer<BinaryScriptStorage> appendedResourcesStorage(QIODevice *device, qint64 &xmlSize)
+    {
+        qint64 deviceSize = device->size();
+        if(device->isSequential() || deviceSize < AppendedResourcesTrailerSize || !device->seek(deviceSize - AppendedResourcesTrailerSize))
+            return QSharedPointer<BinaryScriptStorage>();
+
+        QByteArray trailer = device->read(AppendedResourcesTrailerSize);
+        device->reset();
+
+        const uchar *trailerData = reinterpret_cast<const uchar *>(trailer.constData());
+        if(trailer.size() != AppendedResourcesTrailerSize ||
+           qFromLittleEndian<quint32>(trailerData + 20) != AppendedResourcesMagic ||
+           qFromLittleEndian<quint32>(trailerData + 16) != AppendedResourcesFormatVersion)
+            return QSharedPointer<BinaryScriptStorage>();
+
+        xmlSize = qFromLittleEndian<qint64>(trailerData + 8);
+
+        return QSharedPointer<BinaryScriptStorage>(new BinaryScriptStorage(device));
+    }
+
+    bool readAppendedResources(const QSharedPointer<BinaryScriptStorage> &storage, QHash<QString, ActionTools::Resource> &resources)
+    {
+        const uchar *data = storage->data();
+        qint64 size = storage->size();
+        qint64 indexOffset = qFromLittleEndian<qint64>(data + size - AppendedResourcesTrailerSize);
+        qint64 indexEnd = size - AppendedResourcesTrailerSize;
+
+        //The offsets and sizes come from the file, so they are compared without any sum that could overflow
+        auto available = [&](qint64 offset, qint64 byteCount) { return (offset >= 0 && byteCount >= 0 && byteCount <= indexEnd && offset <= indexEnd - byteCount); };
+
+        if(!available(indexOffset, 4))
+            return false;
+
+        quint32 resourceCount = qFromLittleEndian<quint32>(data + indexOffset);
+        qint64 position = indexOffset + 4;
+
+        for(quint32 resourceIndex = 0; resourceIndex < resourceCount; ++resourceIndex)
+        {
+            if(!available(position, 4))
+                return false;
+
+            quint32 idSize = qFromLittleEndian<quint32>(data + position);
+            position += 4;
+
+            if(idSize > static_cast<quint32>(std::numeric_limits<int>::max()) || !available(position, static_cast<qint64>(idSize) + 24))
+                return false;
+
+            QString id = QString::fromUtf8(reinterpret_cast<const char *>(data + position), static_cast<int>(idSize));
+            position += idSize;
+
+            ActionTools::Resource::Type type = static_cast<ActionTools::Resource::Type>(qFromLittleEndian<quint32>(data + position));
+            qint64 blockOffset = qFromLittleEndian<qint64>(data + position + 4);
+            qint64 resourceSize = qFromLittleEndian<qint64>(data + position + 12);
+            quint32 blockCount = qFromLittleEndian<quint32>(data + position + 20);
+            position += 24;
+
+            //Each block takes at least 4 bytes of the file
+            if(resourceSize < 0 || resourceSize > std::numeric_limits<int>::max() || blockCount > indexEnd / 4)
+                return false;
+
+            //Blocks are a compressed size followed by the qCompress data
+            QVector<QPair<qint64, int>> blocks;
+            blocks.reserve(blockCount);
+            for(quint32 blockIndex = 0; blockIndex < blockCount; ++blockIndex)
+            {
+                if(!available(blockOffset, 4))
+                    return false;
+
+                quint32 blockSize = qFromLittleEndian<quint32>(data + blockOffset);
+                if(blockSize > static_cast<quint32>(std::numeric_limits<int>::max()) || !available(blockOffset + 4, blockSize))
+                    return false;
+
+                blocks.append(qMakePair(blockOffset + 4, static_cast<int>(blockSize)));
+                blockOffset += 4 + blockSize;
+            }
+
+            QSharedPointer<const ActionTools::ResourceSource> source(new AppendedResourceSource(storage, blocks, resourceSize));
+            resources.insert(id, ActionTools::Resource(source, type));
+        }
+
+        return true;
+    }
+}
 
 namespace ActionTools
 {
@@ -46,7 +328,12 @@ namespace ActionTools
 		mLine(-1),
 		mColumn(-1),
 		mPauseBefore(0),
-		mPauseAfter(0)
+		mPauseAfter(0),
+		mLabelsCompiled(false),
+		mNextLine(1),
+		mNextLineIsLabel(false),
+		mDoNotResetPreviousActions(false),
+		mResourceStorage(InlineResources)
 	{
 	}
 
@@ -136,6 +423,9 @@ namespace ActionTools
 
 	int Script::labelLine(const QString &label) const
 	{
+		if(mLabelsCompiled)
+			return mLabelLines.value(label, -1);
+
 		for(int i = 0; i < mActionInstances.count(); ++i)
 		{
 			if(mActionInstances.at(i)->label() == label)
@@ -145,6 +435,69 @@ namespace ActionTools
 		return -1;
 	}
 
+	void Script::compileLabels()
+	{
+		mLabelLines.clear();
+		mLabelLines.reserve(mActionInstances.count());
+
+		//Keep the first occurrence of each label, as labelLine() does
+		for(int i = 0; i < mActionInstances.count(); ++i)
+		{
+			const QString &label = mActionInstances.at(i)->label();
+
+			if(!mLabelLines.contains(label))
+				mLabelLines.insert(label, i);
+		}
+
+		mLabelsCompiled = true;
+	}
+
+	void Script::setNextLine(const QString &nextLine)
+	{
+		bool ok;
+		int line = nextLine.toInt(&ok);
+
+		if(ok)
+			setNextLine(line);
+		else
+		{
+			mNextLineLabel = nextLine;
+			mNextLineIsLabel = true;
+		}
+	}
+
+	int Script::resetActions(int startLine, int endLine)
+	{
+		int resetCount = 0;
+
+		//Only actions that reported holding some state have to be reset
+		for(QSet<int>::iterator actionIt = mActionsToReset.begin(); actionIt != mActionsToReset.end();)
+		{
+			int line = *actionIt;
+
+			if(line >= startLine && line < endLine)
+			{
+				if(ActionInstance *actionInstance = actionAt(line))
+					actionInstance->reset();
+
+				actionIt = mActionsToReset.erase(actionIt);
+				++resetCount;
+			}
+			else
+				++actionIt;
+		}
+
+		return resetCount;
+	}
+
+	QString Script::nextLineString() const
+	{
+		if(mNextLineIsLabel)
+			return mNextLineLabel;
+
+		return QString::number(mNextLine);
+	}
+
 	bool Script::hasEnabledActions() const
 	{
         for(ActionInstance *actionInstance: mActionInstances)
@@ -269,7 +622,16 @@ namespace ActionTools
             stream.writeStartElement("resource");
             stream.writeAttribute("id", resourceIt.key());
             stream.writeAttribute("type", QString::number(resourceIt.value().type()));
-            stream.writeCharacters(qCompress(resourceIt.value().data()).toBase64());
+
+            //Appended resources are written after the XML content, the element stays empty
+            if(mResourceStorage == InlineResources)
+            {
+                //Encoded by parts to avoid holding the whole base64 text, a part size multiple of 3 gives the same encoding
+                QByteArray compressedData = qCompress(resourceIt.value().data());
+                for(int partStart = 0; partStart < compressedData.size(); partStart += Base64PartSize)
+                    stream.writeCharacters(QString::fromLatin1(QByteArray::fromRawData(compressedData.constData() + partStart, qMin(Base64PartSize, compressedData.size() - partStart)).toBase64()));
+            }
+
             stream.writeEndElement();
 
             ++resourceIt;
@@ -350,81 +712,107 @@ namespace ActionTools
 		stream.writeEndElement();
 		stream.writeEndDocument();
 
+        if(mResourceStorage == AppendedResources)
+            return writeAppendedResources(device);
+
 		return true;
 	}
 
-    Script::ReadResult Script::read(QIODevice *device, const Tools::Version &scriptVersion)
-	{
-#ifdef ACT_PROFILE
-		Tools::HighResolutionTimer timer("Script::read");
-#endif
-		mMissingActions.clear();
+    bool Script::writeAppendedResources(QIODevice *device)
+    {
+        qint64 xmlSize = device->pos();
+        qint64 position = xmlSize;
+        QByteArray index;
 
-        emit scriptProcessing(0, 0, tr("Reading schema..."));
+        appendBinaryWord(index, mResources.size());
 
-        ReadResult result = validateSchema(device, scriptVersion);
-        if(result != ReadSuccess)
-            return result;
+        int resourceIndex = 0;
+        for(auto resourceIt = mResources.constBegin(); resourceIt != mResources.constEnd(); ++resourceIt)
+        {
+            emit scriptProcessing(resourceIndex, mResources.size() - 1, tr("Writing resources..."));
 
-        emit scriptProcessing(0, 0, tr("Listing file content..."));
+            //Each block is compressed and written on its own, only one block is held in memory
+            const QByteArray &data = resourceIt.value().data();
+            qint64 firstBlockOffset = position;
+            quint32 blockCount = 0;
+            for(int blockStart = 0; blockStart < data.size(); blockStart += AppendedResourceBlockSize)
+            {
+                QByteArray block = qCompress(reinterpret_cast<const uchar *>(data.constData()) + blockStart, qMin(AppendedResourceBlockSize, data.size() - blockStart));
+                QByteArray blockSize;
+                appendBinaryWord(blockSize, block.size());
 
-        //List the script content
-        device->reset();
+                if(device->write(blockSize) != blockSize.size() || device->write(block) != block.size())
+                    return false;
 
-        int parameterCount = 0;
-        int resourceCount = 0;
-        int actionCount = 0;
+                position += blockSize.size() + block.size();
+                ++blockCount;
+            }
 
-        {
-#ifdef ACT_PROFILE
-            Tools::HighResolutionTimer timer("Listing script content");
-#endif
+            QByteArray id = resourceIt.key().toUtf8();
+            appendBinaryWord(index, id.size());
+            index.append(id);
+            appendBinaryWord(index, resourceIt.value().type());
+            appendBinaryWord(index, static_cast<quint32>(firstBlockOffset));
+            appendBinaryWord(index, static_cast<quint32>(firstBlockOffset >> 32));
+            appendBinaryWord(index, static_cast<quint32>(data.size()));
+            appendBinaryWord(index, 0);
+            appendBinaryWord(index, blockCount);
 
-            QXmlStreamReader stream(device);
-            while(!stream.atEnd() && !stream.hasError())
-            {
-                stream.readNext();
+            ++resourceIndex;
+        }
 
-                if(stream.isStartDocument() || !stream.isStartElement())
-                    continue;
+        QByteArray trailer;
+        appendBinaryWord(trailer, static_cast<quint32>(position));
+        appendBinaryWord(trailer, static_cast<quint32>(position >> 32));
+        appendBinaryWord(trailer, static_cast<quint32>(xmlSize));
+        appendBinaryWord(trailer, static_cast<quint32>(xmlSize >> 32));
+        appendBinaryWord(trailer, AppendedResourcesFormatVersion);
+        appendBinaryWord(trailer, AppendedResourcesMagic);
 
-                if(stream.name() == "parameters")
-                {
-                    stream.readNext();
+        return (device->write(index) == index.size() && device->write(trailer) == trailer.size());
+    }
 
-                    for(;!stream.isEndElement() || stream.name() != "parameters";stream.readNext())
-                    {
-                        if(!stream.isStartElement())
-                            continue;
+    void Script::loadResources()
+    {
+        for(const Resource &resource: mResources)
+            resource.data();
+    }
 
-                        ++parameterCount;
-                    }
-                }
-                else if(stream.name() == "resources")
-                {
-                    stream.readNext();
+    Script::ReadResult Script::read(QIODevice *device, const Tools::Version &scriptVersion, bool trustedInput)
+	{
+#ifdef ACT_PROFILE
+		Tools::HighResolutionTimer timer("Script::read");
+#endif
+		mMissingActions.clear();
 
-                    for(;!stream.isEndElement() || stream.name() != "resources";stream.readNext())
-                    {
-                        if(!stream.isStartElement())
-                            continue;
+        //The XML content is then read from memory, resources after it are only decompressed when used
+        qint64 xmlSize = 0;
+        QSharedPointer<BinaryScriptStorage> appendedStorage = appendedResourcesStorage(device, xmlSize);
+        QHash<QString, Resource> appendedResources;
+        QBuffer xmlBuffer;
+        if(appendedStorage)
+        {
+            if(xmlSize < 0 || xmlSize > appendedStorage->size() - AppendedResourcesTrailerSize || !readAppendedResources(appendedStorage, appendedResources))
+            {
+                mStatusMessage = tr("Invalid resources after the script content");
+                return ReadInvalidSchema;
+            }
 
-                        ++resourceCount;
-                    }
-                }
-                else if(stream.name() == "script")
-                {
-                    stream.readNext();
+            xmlBuffer.setData(QByteArray::fromRawData(reinterpret_cast<const char *>(appendedStorage->data()), xmlSize));
+            xmlBuffer.open(QIODevice::ReadOnly);
+            device = &xmlBuffer;
+        }
 
-                    for(;!stream.isEndElement() || stream.name() != "script";stream.readNext())
-                    {
-                        if(!stream.isStartElement())
-                            continue;
+        //Trusted input is only checked while reading, without schema validation
+        if(!trustedInput)
+        {
+            emit scriptProcessing(0, 0, tr("Reading schema..."));
 
-                        ++actionCount;
-                    }
-                }
-            }
+            ReadResult result = validateSchema(device, scriptVersion);
+            if(result != ReadSuccess)
+                return result;
+
+            device->reset();
         }
 
 		qDeleteAll(mActionInstances);
@@ -432,17 +820,36 @@ namespace ActionTools
 		mParameters.clear();
         mResources.clear();
 
-		device->reset();
-
 #ifdef ACT_PROFILE
 		Tools::HighResolutionTimer timer2("Reading content");
 #endif
 
-        emit scriptProcessing(0, 0, tr("Reading content..."));
-
         QHash<ActionDefinition *, Tools::Version> updatableActionDefinitions;
 
 		QXmlStreamReader stream(device);
+
+        //Progress is computed from the position in the file, so that it is only read once
+        const QString readingParametersDescription = tr("Reading parameters...");
+        const QString readingResourcesDescription = tr("Reading resources...");
+        const QString readingActionsDescription = tr("Reading actions...");
+        qint64 deviceSize = device->isSequential() ? 0 : device->size();
+        int lastProgress = -1;
+        const QString *lastDescription = 0;
+        auto reportProgress = [&](const QString &description)
+        {
+            int progress = (deviceSize > 0 ? static_cast<int>(qMin<qint64>(stream.characterOffset() * 100 / deviceSize, 100)) : 0);
+            if(progress == lastProgress && &description == lastDescription)
+                return;
+
+            lastProgress = progress;
+            lastDescription = &description;
+
+            emit scriptProcessing(progress, (deviceSize > 0 ? 100 : 0), description);
+        };
+
+        emit scriptProcessing(0, 0, tr("Reading content..."));
+
+        bool rootElementRead = false;
 		while(!stream.atEnd() && !stream.hasError())
 		{
 			stream.readNext();
@@ -453,6 +860,16 @@ namespace ActionTools
 			if(!stream.isStartElement())
 				continue;
 
+            if(!rootElementRead)
+            {
+                rootElementRead = true;
+
+                if(stream.name() != "scriptfile")
+                    stream.raiseError(tr("This is not a script file"));
+
+                continue;
+            }
+
 			if(stream.name() == "settings")
 			{
 				const QXmlStreamAttributes &attributes = stream.attributes();
@@ -468,7 +885,7 @@ namespace ActionTools
 			{
 				stream.readNext();
 
-				for(;!stream.isEndElement() || stream.name() != "actions";stream.readNext())
+				for(;!stream.hasError() && (!stream.isEndElement() || stream.name() != "actions");stream.readNext())
 				{
 					if(!stream.isStartElement())
 						continue;
@@ -488,12 +905,12 @@ namespace ActionTools
 			{
 				stream.readNext();
 
-				for(;!stream.isEndElement() || stream.name() != "parameters";stream.readNext())
+				for(;!stream.hasError() && (!stream.isEndElement() || stream.name() != "parameters");stream.readNext())
 				{
 					if(!stream.isStartElement())
 						continue;
 
-                    emit scriptProcessing(mParameters.size(), parameterCount - 1, tr("Reading parameters..."));
+                    reportProgress(readingParametersDescription);
 
 					const QXmlStreamAttributes &attributes = stream.attributes();
 					ScriptParameter scriptParameter(	attributes.value("name").toString(),
@@ -508,16 +925,24 @@ namespace ActionTools
             {
                 stream.readNext();
 
-                for(;!stream.isEndElement() || stream.name() != "resources";stream.readNext())
+                for(;!stream.hasError() && (!stream.isEndElement() || stream.name() != "resources");stream.readNext())
                 {
                     if(!stream.isStartElement())
                         continue;
 
-                    emit scriptProcessing(mResources.size(), resourceCount - 1, tr("Reading resources..."));
+                    reportProgress(readingResourcesDescription);
 
                     const QXmlStreamAttributes &attributes = stream.attributes();
                     QString id = attributes.value("id").toString();
                     QString base64Data = stream.readElementText();
+
+                    auto appendedResourceIt = appendedResources.constFind(id);
+                    if(appendedResourceIt != appendedResources.constEnd())
+                    {
+                        mResources.insert(id, appendedResourceIt.value());
+                        continue;
+                    }
+
                     QByteArray data = qUncompress(QByteArray::fromBase64(base64Data.toLatin1()));
                     Resource resource(data, static_cast<Resource::Type>(attributes.value("type").toString().toInt()));
 
@@ -532,11 +957,13 @@ namespace ActionTools
 
 				stream.readNext();
 
-				for(;!stream.isEndElement() || stream.name() != "script";stream.readNext())
+				for(;!stream.hasError() && (!stream.isEndElement() || stream.name() != "script");stream.readNext())
 				{
 					if(!stream.isStartElement())
 						continue;
 
+                    reportProgress(readingActionsDescription);
+
 					const QXmlStreamAttributes &attributes = stream.attributes();
 					QString name = attributes.value("name").toString();
 					QString label = attributes.value("label").toString();
@@ -557,13 +984,11 @@ namespace ActionTools
 
 					stream.readNext();
 
-					for(;!stream.isEndElement() || stream.name() != "action";stream.readNext())
+					for(;!stream.hasError() && (!stream.isEndElement() || stream.name() != "action");stream.readNext())
 					{
 						if(!stream.isStartElement())
 							continue;
 
-                        emit scriptProcessing(mActionInstances.size(), actionCount - 1, tr("Reading actions..."));
-
 						if(stream.name() == "exception")
 						{
 							const QXmlStreamAttributes &attributes = stream.attributes();
@@ -581,7 +1006,7 @@ namespace ActionTools
 
 							stream.readNext();
 
-							for(;!stream.isEndElement() || stream.name() != "parameter";stream.readNext())
+							for(;!stream.hasError() && (!stream.isEndElement() || stream.name() != "parameter");stream.readNext())
 							{
 								if(!stream.isStartElement())
 									continue;
@@ -600,18 +1025,8 @@ namespace ActionTools
 						}
 					}
 
-                    //Set default values, will be overwritten afterwards, but this is done to make sure we have valid parameters everywhere
-                    for(ElementDefinition *element: actionInstance->definition()->elements())
-                        element->setDefaultValues(actionInstance);
-
 					actionInstance->setLabel(label);
 					actionInstance->setComment(comment);
-
-                    ParametersData defaultParametersData = actionInstance->parametersData();
-                    for(const QString &parameterKey: parametersData.keys())
-                        defaultParametersData[parameterKey] = parametersData.value(parameterKey);
-
-                    actionInstance->setParametersData(defaultParametersData);
 					actionInstance->setColor(color);
 					actionInstance->setEnabled(enabled);
 					actionInstance->setExceptionActionInstances(exceptionActionsHash);
@@ -619,11 +1034,431 @@ namespace ActionTools
 					actionInstance->setPauseAfter(pauseAfter);
 					actionInstance->setTimeout(timeout);
 
-					appendAction(actionInstance);
+					appendReadAction(actionInstance, parametersData);
 				}
 			}
 		}
 
+        if(stream.hasError())
+        {
+            mStatusMessage = stream.errorString();
+            mLine = stream.lineNumber();
+            mColumn = stream.columnNumber();
+
+            return ReadInvalidSchema;
+        }
+
+        updateReadActions(updatableActionDefinitions);
+
+        mResourceStorage = (appendedStorage ? AppendedResources : InlineResources);
+
+		return ReadSuccess;
+	}
+
+    bool Script::writeBinary(QIODevice *device, const Tools::Version &programVersion, const Tools::Version &scriptVersion)
+    {
+#ifdef ACT_PROFILE
+        Tools::HighResolutionTimer timer("Script::writeBinary");
+#endif
+        emit scriptProcessing(0, 0, tr("Writing..."));
+
+        BinaryStringTable strings;
+        QByteArray definitions;
+        QByteArray parameters;
+        QByteArray resources;
+        QByteArray actions;
+        QByteArray subParameters;
+        QByteArray exceptions;
+        quint32 definitionCount = 0;
+        quint32 subParameterCount = 0;
+        quint32 exceptionCount = 0;
+
+        for(int actionIndex: usedActions())
+        {
+            ActionDefinition *actionDefinition = mActionFactory->actionDefinition(actionIndex);
+
+            appendBinaryWord(definitions, strings.index(actionDefinition->id()));
+            appendBinaryWord(definitions, strings.index(actionDefinition->version().toString()));
+            ++definitionCount;
+        }
+
+        for(const ScriptParameter &parameter: mParameters)
+        {
+            appendBinaryWord(parameters, strings.index(parameter.name()));
+            appendBinaryWord(parameters, strings.index(parameter.value()));
+            appendBinaryWord(parameters, parameter.isCode());
+            appendBinaryWord(parameters, parameter.type());
+        }
+
+        //Resource offsets are relative to the aligned resource section, at the end of the file
+        QList<Resource> resourceList;
+        quint64 resourceOffset = 0;
+        for(auto resourceIt = mResources.constBegin(); resourceIt != mResources.constEnd(); ++resourceIt)
+        {
+            quint64 resourceSize = resourceIt.value().data().size();
+
+            appendBinaryWord(resources, strings.index(resourceIt.key()));
+            appendBinaryWord(resources, resourceIt.value().type());
+            appendBinaryWord(resources, static_cast<quint32>(resourceOffset));
+            appendBinaryWord(resources, static_cast<quint32>(resourceOffset >> 32));
+            appendBinaryWord(resources, static_cast<quint32>(resourceSize));
+            appendBinaryWord(resources, static_cast<quint32>(resourceSize >> 32));
+
+            resourceList.append(resourceIt.value());
+            resourceOffset += binaryAlign(resourceSize);
+        }
+
+        for(ActionInstance *actionInstance: mActionInstances)
+        {
+            bool hasColor = (actionInstance->color().isValid() && actionInstance->color() != Qt::transparent);
+            quint32 flags = (actionInstance->isEnabled() ? BinaryActionEnabled : 0) | (hasColor ? BinaryActionHasColor : 0);
+            quint32 firstSubParameter = subParameterCount;
+            quint32 firstException = exceptionCount;
+
+            const ParametersData &parametersData = actionInstance->parametersData();
+            for(auto parameterIt = parametersData.constBegin(); parameterIt != parametersData.constEnd(); ++parameterIt)
+            {
+                quint32 parameterName = strings.index(parameterIt.key());
+                const SubParameterHash &subParameterHash = parameterIt.value().subParameters();
+
+                for(auto subParameterIt = subParameterHash.constBegin(); subParameterIt != subParameterHash.constEnd(); ++subParameterIt)
+                {
+                    appendBinaryWord(subParameters, parameterName);
+                    appendBinaryWord(subParameters, strings.index(subParameterIt.key()));
+                    appendBinaryWord(subParameters, strings.index(subParameterIt.value().value().toString()));
+                    appendBinaryWord(subParameters, subParameterIt.value().isCode());
+                    ++subParameterCount;
+                }
+            }
+
+            const ExceptionActionInstancesHash &exceptionActionsHash = actionInstance->exceptionActionInstances();
+            for(auto exceptionIt = exceptionActionsHash.constBegin(); exceptionIt != exceptionActionsHash.constEnd(); ++exceptionIt)
+            {
+                appendBinaryWord(exceptions, exceptionIt.key());
+                appendBinaryWord(exceptions, exceptionIt.value().action());
+                appendBinaryWord(exceptions, strings.index(exceptionIt.value().line()));
+                ++exceptionCount;
+            }
+
+            appendBinaryWord(actions, strings.index(actionInstance->definition()->id()));
+            appendBinaryWord(actions, strings.index(actionInstance->label()));
+            appendBinaryWord(actions, strings.index(actionInstance->comment()));
+            appendBinaryWord(actions, hasColor ? actionInstance->color().rgba() : 0);
+            appendBinaryWord(actions, flags);
+            appendBinaryWord(actions, actionInstance->pauseBefore());
+            appendBinaryWord(actions, actionInstance->pauseAfter());
+            appendBinaryWord(actions, actionInstance->timeout());
+            appendBinaryWord(actions, firstSubParameter);
+            appendBinaryWord(actions, subParameterCount - firstSubParameter);
+            appendBinaryWord(actions, firstException);
+            appendBinaryWord(actions, exceptionCount - firstException);
+        }
+
+        QString osName = tr("Unknown");
+    #ifdef Q_OS_LINUX
+        osName = tr("GNU/Linux");
+    #endif
+    #ifdef Q_OS_WIN
+        osName = tr("Windows");
+    #endif
+    #ifdef Q_OS_MAC
+        osName = tr("Mac");
+    #endif
+
+        quint32 programName = strings.index("actiona");
+        quint32 programVersionString = strings.index(programVersion.toString());
+        quint32 scriptVersionString = strings.index(scriptVersion.toString());
+        quint32 os = strings.index(osName);
+
+        QByteArray stringEntries;
+        QByteArray stringData;
+        for(const QString &string: strings.strings())
+        {
+            QByteArray utf8String = string.toUtf8();
+
+            appendBinaryWord(stringEntries, stringData.size());
+            appendBinaryWord(stringEntries, utf8String.size());
+            stringData.append(utf8String);
+        }
+
+        QByteArray header;
+        appendBinaryWord(header, BinaryScriptMagic);
+        appendBinaryWord(header, BinaryScriptFormatVersion);
+        appendBinaryWord(header, programName);
+        appendBinaryWord(header, programVersionString);
+        appendBinaryWord(header, scriptVersionString);
+        appendBinaryWord(header, os);
+        appendBinaryWord(header, pauseBefore());
+        appendBinaryWord(header, pauseAfter());
+        appendBinaryWord(header, strings.strings().size());
+        appendBinaryWord(header, definitionCount);
+        appendBinaryWord(header, mParameters.size());
+        appendBinaryWord(header, mResources.size());
+        appendBinaryWord(header, mActionInstances.size());
+        appendBinaryWord(header, subParameterCount);
+        appendBinaryWord(header, exceptionCount);
+        appendBinaryWord(header, stringData.size());
+
+        qint64 position = 0;
+        for(const QByteArray *section: {&header, &stringEntries, &definitions, &parameters, &resources, &actions, &subParameters, &exceptions, &stringData})
+        {
+            if(device->write(*section) != section->size())
+                return false;
+
+            position += section->size();
+        }
+
+        //Resources are written as they are, without a copy
+        int resourceIndex = 0;
+        for(const Resource &resource: resourceList)
+        {
+            emit scriptProcessing(resourceIndex, resourceList.size() - 1, tr("Writing resources..."));
+
+            QByteArray padding(static_cast<int>(binaryAlign(position) - position), '\0');
+            if(device->write(padding) != padding.size() || device->write(resource.data()) != resource.data().size())
+                return false;
+
+            position += padding.size() + resource.data().size();
+            ++resourceIndex;
+        }
+
+        return true;
+    }
+
+    Script::ReadResult Script::readBinary(QIODevice *device, const Tools::Version &scriptVersion)
+    {
+#ifdef ACT_PROFILE
+        Tools::HighResolutionTimer timer("Script::readBinary");
+#endif
+        mMissingActions.clear();
+        mStatusMessage.clear();
+        mLine = -1;
+        mColumn = -1;
+
+        emit scriptProcessing(0, 0, tr("Reading content..."));
+
+        QSharedPointer<BinaryScriptStorage> storage(new BinaryScriptStorage(device));
+        const uchar *data = storage->data();
+        quint64 size = storage->size();
+
+        auto word = [data](quint64 offset) { return qFromLittleEndian<quint32>(data + offset); };
+
+        if(size < BinaryHeaderWords * sizeof(quint32) || word(0) != BinaryScriptMagic || word(4) != BinaryScriptFormatVersion)
+        {
+            mStatusMessage = tr("This is not a binary script file");
+            return ReadInvalidSchema;
+        }
+
+        quint64 stringCount = word(8 * 4);
+        quint64 definitionCount = word(9 * 4);
+        quint64 parameterCount = word(10 * 4);
+        quint64 resourceCount = word(11 * 4);
+        quint64 actionCount = word(12 * 4);
+        quint64 subParameterCount = word(13 * 4);
+        quint64 exceptionCount = word(14 * 4);
+        quint64 stringDataSize = word(15 * 4);
+
+        //Every section has fixed size records, their offsets only depend on the counts
+        const quint64 stringsOffset = BinaryHeaderWords * sizeof(quint32);
+        const quint64 definitionsOffset = stringsOffset + stringCount * BinaryStringWords * sizeof(quint32);
+        const quint64 parametersOffset = definitionsOffset + definitionCount * BinaryDefinitionWords * sizeof(quint32);
+        const quint64 resourcesOffset = parametersOffset + parameterCount * BinaryParameterWords * sizeof(quint32);
+        const quint64 actionsOffset = resourcesOffset + resourceCount * BinaryResourceWords * sizeof(quint32);
+        const quint64 subParametersOffset = actionsOffset + actionCount * BinaryActionWords * sizeof(quint32);
+        const quint64 exceptionsOffset = subParametersOffset + subParameterCount * BinarySubParameterWords * sizeof(quint32);
+        const quint64 stringDataOffset = exceptionsOffset + exceptionCount * BinaryExceptionWords * sizeof(quint32);
+        const quint64 resourceDataOffset = binaryAlign(stringDataOffset + stringDataSize);
+
+        if(stringDataOffset + stringDataSize > size)
+        {
+            mStatusMessage = tr("Truncated binary script file");
+            return ReadInvalidSchema;
+        }
+
+        QVector<QString> strings(stringCount);
+        for(quint64 stringIndex = 0; stringIndex < stringCount; ++stringIndex)
+        {
+            quint64 entryOffset = stringsOffset + stringIndex * BinaryStringWords * sizeof(quint32);
+            quint64 stringOffset = word(entryOffset);
+            quint64 stringSize = word(entryOffset + 4);
+
+            if(stringOffset + stringSize > stringDataSize)
+            {
+                mStatusMessage = tr("Invalid string in binary script file");
+                return ReadInvalidSchema;
+            }
+
+            strings[stringIndex] = QString::fromUtf8(reinterpret_cast<const char *>(data + stringDataOffset + stringOffset), stringSize);
+        }
+
+        bool validStrings = true;
+        auto string = [&strings, &validStrings, &word](quint64 offset) -> QString
+        {
+            quint32 stringIndex = word(offset);
+            if(stringIndex >= static_cast<quint32>(strings.size()))
+            {
+                validStrings = false;
+                return QString();
+            }
+
+            return strings.at(stringIndex);
+        };
+
+        mProgramName = string(2 * 4);
+        mProgramVersion = Tools::Version(string(3 * 4));
+        mScriptVersion = Tools::Version(string(4 * 4));
+        mOs = string(5 * 4);
+
+        if(mScriptVersion > scriptVersion)
+            return ReadInvalidScriptVersion;
+
+        qDeleteAll(mActionInstances);
+        mActionInstances.clear();
+        mParameters.clear();
+        mResources.clear();
+
+        setPauseBefore(static_cast<qint32>(word(6 * 4)));
+        setPauseAfter(static_cast<qint32>(word(7 * 4)));
+
+        QHash<ActionDefinition *, Tools::Version> updatableActionDefinitions;
+
+        for(quint64 definitionIndex = 0; definitionIndex < definitionCount; ++definitionIndex)
+        {
+            quint64 recordOffset = definitionsOffset + definitionIndex * BinaryDefinitionWords * sizeof(quint32);
+            QString name = string(recordOffset);
+            Tools::Version version(string(recordOffset + 4));
+
+            ActionDefinition *actionDefinition = mActionFactory->actionDefinition(name);
+            if(!actionDefinition)
+                mMissingActions << name;
+            else if(actionDefinition->version() > version)
+                updatableActionDefinitions[actionDefinition] = version;
+        }
+
+        for(quint64 parameterIndex = 0; parameterIndex < parameterCount; ++parameterIndex)
+        {
+            quint64 recordOffset = parametersOffset + parameterIndex * BinaryParameterWords * sizeof(quint32);
+
+            mParameters.append(ScriptParameter(string(recordOffset),
+                                               string(recordOffset + 4),
+                                               word(recordOffset + 8) != 0,
+                                               static_cast<ScriptParameter::ParameterType>(word(recordOffset + 12))));
+        }
+
+        //Resources are only read from the file when they are used
+        for(quint64 resourceIndex = 0; resourceIndex < resourceCount; ++resourceIndex)
+        {
+            quint64 recordOffset = resourcesOffset + resourceIndex * BinaryResourceWords * sizeof(quint32);
+            quint64 relativeOffset = word(recordOffset + 8) | (static_cast<quint64>(word(recordOffset + 12)) << 32);
+            quint64 resourceSize = word(recordOffset + 16) | (static_cast<quint64>(word(recordOffset + 20)) << 32);
+
+            //Both values come from the file: compared by subtracting, so that no sum can wrap
+            if(resourceDataOffset > size ||
+               resourceSize > size - resourceDataOffset ||
+               relativeOffset > size - resourceDataOffset - resourceSize ||
+               resourceSize > static_cast<quint64>(std::numeric_limits<int>::max()))
+            {
+                mStatusMessage = tr("Invalid resource in binary script file");
+                return ReadInvalidSchema;
+            }
+
+            quint64 resourceOffset = resourceDataOffset + relativeOffset;
+
+            QSharedPointer<const ResourceSource> source(new BinaryResourceSource(storage, resourceOffset, resourceSize));
+            mResources.insert(string(recordOffset), Resource(source, static_cast<Resource::Type>(word(recordOffset + 4))));
+        }
+
+        emit scriptProcessing(0, 0, tr("Reading actions..."));
+
+        for(quint64 actionIndex = 0; actionIndex < actionCount; ++actionIndex)
+        {
+            quint64 recordOffset = actionsOffset + actionIndex * BinaryActionWords * sizeof(quint32);
+            quint64 firstSubParameter = word(recordOffset + 32);
+            quint64 actionSubParameterCount = word(recordOffset + 36);
+            quint64 firstException = word(recordOffset + 40);
+            quint64 actionExceptionCount = word(recordOffset + 44);
+
+            if(firstSubParameter + actionSubParameterCount > subParameterCount || firstException + actionExceptionCount > exceptionCount)
+            {
+                mStatusMessage = tr("Invalid action in binary script file");
+                return ReadInvalidSchema;
+            }
+
+            ActionInstance *actionInstance = mActionFactory->newActionInstance(string(recordOffset));
+            if(!actionInstance)
+                continue;
+
+            ParametersData parametersData;
+            for(quint64 subParameterIndex = firstSubParameter; subParameterIndex < firstSubParameter + actionSubParameterCount; ++subParameterIndex)
+            {
+                quint64 subParameterOffset = subParametersOffset + subParameterIndex * BinarySubParameterWords * sizeof(quint32);
+                SubParameter subParameterData;
+
+                subParameterData.setCode(word(subParameterOffset + 12) != 0);
+                subParameterData.setValue(string(subParameterOffset + 8));
+
+                parametersData[string(subParameterOffset)].subParameters().insert(string(subParameterOffset + 4), subParameterData);
+            }
+
+            ExceptionActionInstancesHash exceptionActionsHash;
+            for(quint64 exceptionIndex = firstException; exceptionIndex < firstException + actionExceptionCount; ++exceptionIndex)
+            {
+                quint64 exceptionOffset = exceptionsOffset + exceptionIndex * BinaryExceptionWords * sizeof(quint32);
+
+                exceptionActionsHash.insert(static_cast<ActionException::Exception>(word(exceptionOffset)),
+                                            ActionException::ExceptionActionInstance(static_cast<ActionException::ExceptionAction>(word(exceptionOffset + 4)),
+                                                                                     string(exceptionOffset + 8)));
+            }
+
+            quint32 flags = word(recordOffset + 16);
+
+            actionInstance->setLabel(string(recordOffset + 4));
+            actionInstance->setComment(string(recordOffset + 8));
+            actionInstance->setColor((flags & BinaryActionHasColor) ? QColor::fromRgba(word(recordOffset + 12)) : QColor());
+            actionInstance->setEnabled(flags & BinaryActionEnabled);
+            actionInstance->setExceptionActionInstances(exceptionActionsHash);
+            actionInstance->setPauseBefore(static_cast<qint32>(word(recordOffset + 20)));
+            actionInstance->setPauseAfter(static_cast<qint32>(word(recordOffset + 24)));
+            actionInstance->setTimeout(static_cast<qint32>(word(recordOffset + 28)));
+
+            appendReadAction(actionInstance, parametersData);
+        }
+
+        if(!validStrings)
+        {
+            mStatusMessage = tr("Invalid string in binary script file");
+            return ReadInvalidSchema;
+        }
+
+        updateReadActions(updatableActionDefinitions);
+
+        return ReadSuccess;
+    }
+
+    bool Script::isBinaryScript(QIODevice *device)
+    {
+        QByteArray magic = device->peek(sizeof(quint32));
+
+        return (magic.size() == static_cast<int>(sizeof(quint32)) && qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(magic.constData())) == BinaryScriptMagic);
+    }
+
+    void Script::appendReadAction(ActionInstance *actionInstance, const QHash<QString, Parameter> &parametersData)
+    {
+        //Set default values, will be overwritten afterwards, but this is done to make sure we have valid parameters everywhere
+        for(ElementDefinition *element: actionInstance->definition()->elements())
+            element->setDefaultValues(actionInstance);
+
+        ParametersData defaultParametersData = actionInstance->parametersData();
+        for(const QString &parameterKey: parametersData.keys())
+            defaultParametersData[parameterKey] = parametersData.value(parameterKey);
+
+        actionInstance->setParametersData(defaultParametersData);
+
+        appendAction(actionInstance);
+    }
+
+    void Script::updateReadActions(const QHash<ActionDefinition *, Tools::Version> &updatableActionDefinitions)
+    {
         for(ActionDefinition *actionDefinition: updatableActionDefinitions.keys())
         {
             for(ActionInstance *actionInstance: mActionInstances)
@@ -632,9 +1467,7 @@ namespace ActionTools
                     actionDefinition->updateAction(actionInstance, updatableActionDefinitions.value(actionDefinition));
             }
         }
-
-		return ReadSuccess;
-	}
+    }
 
     bool Script::validateContent(const QString &content, const Tools::Version &scriptVersion)
 	{
@@ -646,17 +1479,12 @@ namespace ActionTools
 
 		MessageHandler messageHandler;
 
-        QFile schemaFile(QString(":/script%1.xsd").arg(scriptVersion.toString()));
-		if(!schemaFile.open(QIODevice::ReadOnly))
-			return false;
-
-		QXmlSchema schema;
-		schema.setMessageHandler(&messageHandler);
-
-		if(!schema.load(&schemaFile))
+        const QXmlSchema *schema = compiledSchema(scriptVersion);
+        if(!schema)
 			return false;
 
-		QXmlSchemaValidator validator(schema);
+		QXmlSchemaValidator validator(*schema);
+		validator.setMessageHandler(&messageHandler);
 		if(!validator.validate(&buffer))
 		{
 			mStatusMessage = messageHandler.statusMessage();
@@ -717,26 +1545,16 @@ namespace ActionTools
     {
         MessageHandler messageHandler;
 
-        QFile schemaFile(QString(":/script%1.xsd").arg(scriptVersion.toString()));
-        if(!schemaFile.open(QIODevice::ReadOnly))
+        const QXmlSchema *schema = compiledSchema(scriptVersion);
+        if(!schema)
             return ReadInternal;
 
-        QXmlSchema schema;
-        schema.setMessageHandler(&messageHandler);
-
-        {
-#ifdef ACT_PROFILE
-            Tools::HighResolutionTimer timer("loading schema file");
-#endif
-            if(!schema.load(&schemaFile))
-                return ReadInternal;
-        }
-
         {
 #ifdef ACT_PROFILE
             Tools::HighResolutionTimer timer("validating file");
 #endif
-            QXmlSchemaValidator validator(schema);
+            QXmlSchemaValidator validator(*schema);
+            validator.setMessageHandler(&messageHandler);
             if(!validator.validate(device))
             {
                 mStatusMessage = messageHandler.statusMessage();
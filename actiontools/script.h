@@ -30,6 +30,7 @@
 #include <QStringList>
 #include <QHash>
 #include <QStack>
+#include <QSet>
 
 class QIODevice;
 
@@ -37,7 +38,9 @@ namespace ActionTools
 {
 	class ActionInstance;
 	class ActionFactory;
+	class ActionDefinition;
     class ElementDefinition;
+    class Parameter;
 
 	class ACTIONTOOLSSHARED_EXPORT Script : public QObject
 	{
@@ -52,6 +55,11 @@ namespace ActionTools
             ReadInvalidScriptVersion,	// Script version is newer than ours
             ReadCanceled                // Loading was canceled
 		};
+		enum ResourceStorage
+		{
+			InlineResources,			// Compressed and base64 encoded in the XML content
+			AppendedResources			// Compressed by blocks after the XML content, read when used
+		};
 
         static const QRegExp CodeVariableDeclarationRegExp;
 
@@ -75,7 +83,20 @@ namespace ActionTools
 		QSet<int> usedActions() const;
 
 		bool write(QIODevice *device, const Tools::Version &programVersion, const Tools::Version &scriptVersion);
-		ReadResult read(QIODevice *device, const Tools::Version &scriptVersion);
+		//Trusted input (generated scripts) is not validated against the schema, only checked while it is read
+		ReadResult read(QIODevice *device, const Tools::Version &scriptVersion, bool trustedInput = false);
+
+		//Compiled binary scripts (.ascb): no XML parsing, files are memory-mapped and resources are only read when used
+		bool writeBinary(QIODevice *device, const Tools::Version &programVersion, const Tools::Version &scriptVersion);
+		ReadResult readBinary(QIODevice *device, const Tools::Version &scriptVersion);
+		static bool isBinaryScript(QIODevice *device);
+
+		//Set when reading a script, appended resources are kept appended when writing it back
+		void setResourceStorage(ResourceStorage resourceStorage)	{ mResourceStorage = resourceStorage; }
+		ResourceStorage resourceStorage() const					{ return mResourceStorage; }
+
+		//Resources that have not been used yet are still read from the script file: call this before overwriting it
+		void loadResources();
         bool validateContent(const QString &content, const Tools::Version &scriptVersion);
         const QString &statusMessage() const                                            { return mStatusMessage; }
         int line() const                                                                { return mLine; }
@@ -100,9 +121,26 @@ namespace ActionTools
         int findProcedure(const QString &procedureName) const                           { return mProcedures.value(procedureName, -1); }
         void clearProcedures()                                                          { mProcedures.clear(); }
 
+        void compileLabels();
+        void clearCompiledLabels()                                                      { mLabelLines.clear(); mLabelsCompiled = false; }
+
+        void setNextLine(int nextLine)                                                  { mNextLine = nextLine; mNextLineIsLabel = false; }
+        void setNextLine(const QString &nextLine);
+        int nextLine() const                                                            { return mNextLine; }
+        bool nextLineIsLabel() const                                                    { return mNextLineIsLabel; }
+        const QString &nextLineLabel() const                                            { return mNextLineLabel; }
+        QString nextLineString() const;
+        void setDoNotResetPreviousActions(bool doNotResetPreviousActions)               { mDoNotResetPreviousActions = doNotResetPreviousActions; }
+        bool doNotResetPreviousActions() const                                          { return mDoNotResetPreviousActions; }
+
+        void setActionNeedsReset(int line)                                              { mActionsToReset.insert(line); }
+        void clearActionsToReset()                                                      { mActionsToReset.clear(); }
+        int resetActions(int startLine, int endLine);
+
         void addProcedureCall(int callerLine)                                           { mCallStack.push(callerLine); }
         bool hasProcedureCall() const                                                   { return !mCallStack.isEmpty(); }
         int popProcedureCall()                                                          { return mCallStack.pop(); }
+        int procedureCallDepth() const                                                  { return mCallStack.size(); }
         void clearCallStack()                                                           { mCallStack.clear(); }
 
         void addResource(const QString &id, const QByteArray &data, Resource::Type type){ mResources.insert(id, Resource(data, type)); }
@@ -120,6 +158,9 @@ namespace ActionTools
         void scriptProcessing(int progress, int total, const QString &description);
 
 	private:
+        bool writeAppendedResources(QIODevice *device);
+        void appendReadAction(ActionInstance *actionInstance, const QHash<QString, Parameter> &parametersData);
+        void updateReadActions(const QHash<ActionDefinition *, Tools::Version> &updatableActionDefinitions);
         Script::ReadResult validateSchema(QIODevice *device, const Tools::Version &scriptVersion, bool tryOlderVersions = true);
         void parametersFromDefinition(QSet<QString> &variables, const ActionInstance *actionInstance, const ActionTools::ElementDefinition *elementDefinition) const;
         void findVariablesInAction(ActionInstance *actionInstance, QSet<QString> &result) const;
@@ -138,8 +179,16 @@ namespace ActionTools
 		int mPauseBefore;
 		int mPauseAfter;
 		QHash<QString, int> mProcedures;
+		QHash<QString, int> mLabelLines;
+		bool mLabelsCompiled;
+		int mNextLine;
+		bool mNextLineIsLabel;
+		QString mNextLineLabel;
+		bool mDoNotResetPreviousActions;
+		QSet<int> mActionsToReset;
 		QStack<int> mCallStack;
         QHash<QString, Resource> mResources;
+		ResourceStorage mResourceStorage;
 
 		Q_DISABLE_COPY(Script)
 	};
@@ -0,0 +1,26 @@
+include(../common.pri)
+unix:!mac:QMAKE_LFLAGS += -Wl,--rpath=\\\$\$ORIGIN -Wl,--rpath=$${PREFIX}/$${LIBDIR}/actiona
+QT += xml \
+    network \
+    script \
+    scripttools
+equals(QT_MAJOR_VERSION, 5) {
+QT += widgets
+}
+CONFIG += console
+CONFIG -= app_bundle
+TARGET = actbench
+DESTDIR = ..
+SOURCES += main.cpp
+INCLUDEPATH += . \
+    .. \
+    ../tools \
+	../actiontools
+win32:LIBS += -luser32 \
+    -ladvapi32 \
+    -lole32
+unix:LIBS += -lXtst
+LIBS += -L.. \
+    -ltools \
+    -lactiontools \
+    -lexecuter
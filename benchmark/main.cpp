@@ -0,0 +1,396 @@
+/*
+	Actiona
+	Copyright (C) 2005-2017 Jonathan Mercier-Ganady
+
+	Actiona is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Actiona is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+	Contact : jmgr@jmgr.info
+*/
+
+#include "qxtcommandoptions/qxtcommandoptions.h"
+#include "actioninstance.h"
+#include "actionexception.h"
+#include "actionfactory.h"
+#include "script.h"
+#include "executer/executer.h"
+#include "opencvalgorithms.h"
+#include "version.h"
+
+#include <functional>
+#include <limits>
+
+#include <QApplication>
+#include <QTextStream>
+#include <QTemporaryFile>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QSettings>
+#include <QLocale>
+#include <QDir>
+#include <QImage>
+
+//Generates scripts of a given size and measures how fast they are written, read and executed.
+//The execution needs a QPA platform, use QT_QPA_PLATFORM=offscreen to run it without a display.
+
+static const Tools::Version ActionaVersion = Tools::Version(VERSION_TO_STRING(ACT_VERSION));
+static const Tools::Version ScriptVersion = Tools::Version(VERSION_TO_STRING(ACT_SCRIPT_VERSION));
+
+//Amount of variable names used by the generated actions
+static const int VariableCount = 16;
+
+struct BenchmarkOptions
+{
+	int resourceCount;
+	int resourceSize;
+	int repeat;
+	bool execute;
+	bool releaseMode;
+};
+
+//Fills the script with Variable and Code actions using text and code parameters, and ends it with a Loop going back to the first one
+static void generateScript(ActionTools::Script &script, int actionCount, const BenchmarkOptions &options)
+{
+	for(int actionIndex = 0; actionIndex < actionCount - 1; ++actionIndex)
+	{
+		ActionTools::ActionInstance *actionInstance;
+		int group = (actionIndex / 3) % VariableCount;
+
+		switch(actionIndex % 3)
+		{
+		case 0:
+			actionInstance = script.appendAction("ActionVariable");
+			if(!actionInstance)
+				return;
+
+			actionInstance->setSubParameter("variable", "value", QString("text%1").arg(group));
+			actionInstance->setSubParameter("type", "value", QString("string"));
+			actionInstance->setSubParameter("value", "value", QString("item %1").arg(actionIndex));
+			break;
+		case 1:
+			actionInstance = script.appendAction("ActionCode");
+			if(!actionInstance)
+				return;
+
+			actionInstance->setSubParameter("code", "value", true, QString("var number%1 = %2 * 2;").arg(group).arg(actionIndex));
+			break;
+		default:
+			actionInstance = script.appendAction("ActionVariable");
+			if(!actionInstance)
+				return;
+
+			actionInstance->setSubParameter("variable", "value", QString("code%1").arg(group));
+			actionInstance->setSubParameter("type", "value", QString("string"));
+			actionInstance->setSubParameter("value", "value", true, QString("text%1 + '-' + number%1").arg(group));
+			break;
+		}
+
+		if(actionIndex == 0)
+			actionInstance->setLabel("start");
+	}
+
+	//The whole script is executed twice
+	ActionTools::ActionInstance *loopInstance = script.appendAction("ActionLoop");
+	if(!loopInstance)
+		return;
+
+	loopInstance->setSubParameter("line", "value", QString("start"));
+	loopInstance->setSubParameter("count", "value", QString("1"));
+
+	for(int resourceIndex = 0; resourceIndex < options.resourceCount; ++resourceIndex)
+	{
+		QByteArray data(options.resourceSize, Qt::Uninitialized);
+		for(int byteIndex = 0; byteIndex < data.size(); ++byteIndex)
+			data[byteIndex] = static_cast<char>(qrand());
+
+		script.addResource(QString("resource%1").arg(resourceIndex), data, ActionTools::Resource::BinaryType);
+	}
+}
+
+//Returns the best time of several runs, in milliseconds, or a negative value if a run failed
+static double measure(int repeat, const std::function<bool ()> &function)
+{
+	double best = std::numeric_limits<double>::max();
+
+	for(int run = 0; run < repeat; ++run)
+	{
+		QElapsedTimer timer;
+		timer.start();
+
+		if(!function())
+			return -1.0;
+
+		best = qMin(best, timer.nsecsElapsed() / 1000000.0);
+	}
+
+	return best;
+}
+
+static void printResult(QTextStream &stream, const QString &name, int count, double milliseconds, const QString &unit = "actions")
+{
+	stream << QString("%1 %2 %3").arg(name, -32).arg(count, 7).arg(unit, -7);
+
+	if(milliseconds < 0.0)
+		stream << "   " << QObject::tr("failed") << "\n";
+	else
+	{
+		double countPerSecond = (milliseconds > 0.0 ? count * 1000.0 / milliseconds : 0.0);
+
+		stream << QString("%1 ms %2 %3/s").arg(milliseconds, 12, 'f', 3).arg(countPerSecond, 14, 'f', 0).arg(unit) << "\n";
+	}
+
+	stream.flush();
+}
+
+static bool writeScript(ActionTools::Script &script, QFile &file, bool binary)
+{
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+
+	bool result = (binary ?
+					   script.writeBinary(&file, ActionaVersion, ScriptVersion) :
+					   script.write(&file, ActionaVersion, ScriptVersion));
+
+	file.close();
+
+	return result;
+}
+
+static bool readScript(ActionTools::ActionFactory &actionFactory, QFile &file, bool binary, bool trustedInput)
+{
+	ActionTools::Script script(&actionFactory);
+
+	if(!file.open(QIODevice::ReadOnly))
+		return false;
+
+	ActionTools::Script::ReadResult result = (binary ?
+												  script.readBinary(&file, ScriptVersion) :
+												  script.read(&file, ScriptVersion, trustedInput));
+
+	//Resources stored after the XML or in the binary format are only loaded when used
+	script.loadResources();
+
+	file.close();
+
+	return (result == ActionTools::Script::ReadSuccess);
+}
+
+static void runBenchmark(QTextStream &stream, ActionTools::ActionFactory &actionFactory, int actionCount, const BenchmarkOptions &options)
+{
+	ActionTools::Script script(&actionFactory);
+
+	generateScript(script, actionCount, options);
+
+	if(script.actionCount() != actionCount)
+	{
+		stream << QObject::tr("Unable to create the actions, are the action packs installed?") << "\n";
+		stream.flush();
+		return;
+	}
+
+	QTemporaryFile xmlFile(QDir::tempPath() + "/actbench-XXXXXX.ascr");
+	QTemporaryFile appendedFile(QDir::tempPath() + "/actbench-XXXXXX.ascr");
+	QTemporaryFile binaryFile(QDir::tempPath() + "/actbench-XXXXXX.ascb");
+	if(!xmlFile.open() || !appendedFile.open() || !binaryFile.open())
+	{
+		stream << QObject::tr("Unable to create the temporary files") << "\n";
+		stream.flush();
+		return;
+	}
+
+	xmlFile.close();
+	appendedFile.close();
+	binaryFile.close();
+
+	printResult(stream, "Script::write", actionCount, measure(options.repeat, [&]
+	{
+		script.setResourceStorage(ActionTools::Script::InlineResources);
+		return writeScript(script, xmlFile, false);
+	}));
+	printResult(stream, "Script::write (appended)", actionCount, measure(options.repeat, [&]
+	{
+		script.setResourceStorage(ActionTools::Script::AppendedResources);
+		return writeScript(script, appendedFile, false);
+	}));
+	printResult(stream, "Script::writeBinary", actionCount, measure(options.repeat, [&]
+	{
+		return writeScript(script, binaryFile, true);
+	}));
+	printResult(stream, "Script::read", actionCount, measure(options.repeat, [&]
+	{
+		return readScript(actionFactory, xmlFile, false, false);
+	}));
+	printResult(stream, "Script::read (trusted)", actionCount, measure(options.repeat, [&]
+	{
+		return readScript(actionFactory, xmlFile, false, true);
+	}));
+	printResult(stream, "Script::read (appended)", actionCount, measure(options.repeat, [&]
+	{
+		return readScript(actionFactory, appendedFile, false, false);
+	}));
+	printResult(stream, "Script::readBinary", actionCount, measure(options.repeat, [&]
+	{
+		return readScript(actionFactory, binaryFile, true, false);
+	}));
+
+	if(!options.execute)
+		return;
+
+	LibExecuter::Executer executer;
+	QEventLoop eventLoop;
+	bool executionStopped = false;
+	int executedActionCount = 0;
+
+	QObject::connect(&executer, &LibExecuter::Executer::executionStopped, [&]
+	{
+		executionStopped = true;
+		eventLoop.quit();
+	});
+	QObject::connect(&executer, &LibExecuter::Executer::actionEnded, [&]
+	{
+		++executedActionCount;
+	});
+
+	executer.setReleaseMode(options.releaseMode);
+	executer.setup(&script, &actionFactory, false, 0, 0, false, 0, 0, 0, 0, ActionaVersion, ScriptVersion, true, 0);
+
+	QElapsedTimer timer;
+	timer.start();
+
+	if(!executer.startExecution(false, xmlFile.fileName()))
+	{
+		printResult(stream, "Executer::startExecution", actionCount, -1.0);
+		return;
+	}
+
+	printResult(stream, "Executer::startExecution", actionCount, timer.nsecsElapsed() / 1000000.0);
+
+	timer.restart();
+
+	if(!executionStopped)
+		eventLoop.exec();
+
+	double executionTime = timer.nsecsElapsed() / 1000000.0;
+
+	printResult(stream, "Execution", executedActionCount, executer.hasExecutionFailed() ? -1.0 : executionTime);
+}
+
+//Searches an image in 1 to 8 screen-sized sources, to measure how the search scales with the amount of sources
+static void runFindImageBenchmark(QTextStream &stream, int repeat)
+{
+	QImage source(1920, 1080, QImage::Format_RGB32);
+	for(int y = 0; y < source.height(); ++y)
+	{
+		QRgb *line = reinterpret_cast<QRgb *>(source.scanLine(y));
+
+		for(int x = 0; x < source.width(); ++x)
+			line[x] = qRgb(qrand() % 256, qrand() % 256, qrand() % 256);
+	}
+
+	QImage target = source.copy(1200, 700, 64, 64);
+	ActionTools::OpenCVAlgorithms openCVAlgorithms;
+	QList<QImage> sources;
+
+	for(int sourceCount = 1; sourceCount <= 8; ++sourceCount)
+	{
+		sources.append(source);
+
+		printResult(stream, "OpenCVAlgorithms::findSubImage", sourceCount, measure(repeat, [&]
+		{
+			ActionTools::MatchingPointList matchingPointList;
+
+			return openCVAlgorithms.findSubImage(sources, target, matchingPointList) && matchingPointList.size() == sourceCount;
+		}), "sources");
+	}
+}
+
+int main(int argc, char **argv)
+{
+	QApplication app(argc, argv);
+	app.setQuitOnLastWindowClosed(false);
+
+	qRegisterMetaType<ActionTools::ActionInstance>("ActionInstance");
+	qRegisterMetaType<ActionTools::ActionException::Exception>("Exception");
+	qRegisterMetaType<ActionTools::Parameter>("Parameter");
+	qRegisterMetaType<ActionTools::SubParameter>("SubParameter");
+	qRegisterMetaType<Tools::Version>("Version");
+
+	QxtCommandOptions options;
+	options.setFlagStyle(QxtCommandOptions::DoubleDash);
+	options.setScreenWidth(0);
+	options.add("actions", QObject::tr("comma-separated amounts of actions of the generated scripts, default is 1000,10000,100000"), QxtCommandOptions::ValueRequired);
+	options.add("resources", QObject::tr("amount of resources added to each script, default is 8"), QxtCommandOptions::ValueRequired);
+	options.add("resource-size", QObject::tr("size of each resource in KiB, default is 64"), QxtCommandOptions::ValueRequired);
+	options.add("repeat", QObject::tr("amount of times each read and write is repeated, the best time is kept, default is 3"), QxtCommandOptions::ValueRequired);
+	options.add("no-execution", QObject::tr("do not execute the generated scripts"));
+	options.add("find-image", QObject::tr("measure image searches in 1 to 8 sources instead of scripts"));
+	options.add("release", QObject::tr("execute without the script debugger"));
+	options.add("seed", QObject::tr("seed used to generate the scripts and images, default is 1"), QxtCommandOptions::ValueRequired);
+	options.add("help", QObject::tr("show this help text"));
+	options.alias("help", "h");
+	options.parse(QCoreApplication::arguments());
+
+	if(options.count("help") || options.showUnrecognizedWarning())
+	{
+		QTextStream stream(stdout);
+		stream << QObject::tr("usage: ") << QCoreApplication::arguments().at(0) << " " << QObject::tr("[parameters]") << "\n";
+		stream << QObject::tr("Parameters are:") << "\n";
+		stream << options.getUsage();
+		stream.flush();
+		return -1;
+	}
+
+	//A fixed seed keeps the generated inputs identical between runs
+	qsrand(options.value("seed").isValid() ? options.value("seed").toUInt() : 1);
+
+	BenchmarkOptions benchmarkOptions;
+	benchmarkOptions.resourceCount = options.value("resources").isValid() ? options.value("resources").toInt() : 8;
+	benchmarkOptions.resourceSize = (options.value("resource-size").isValid() ? options.value("resource-size").toInt() : 64) * 1024;
+	benchmarkOptions.repeat = qMax(1, options.value("repeat").isValid() ? options.value("repeat").toInt() : 3);
+	benchmarkOptions.execute = (options.count("no-execution") == 0);
+	benchmarkOptions.releaseMode = (options.count("release") > 0);
+
+	QList<int> actionCounts;
+	foreach(const QString &actionCount, options.value("actions").toString().split(',', QString::SkipEmptyParts))
+	{
+		//At least one action of each kind and the final loop
+		if(actionCount.toInt() >= 4)
+			actionCounts << actionCount.toInt();
+	}
+
+	if(actionCounts.isEmpty())
+		actionCounts << 1000 << 10000 << 100000;
+
+	QTextStream stream(stdout);
+
+	if(options.count("find-image"))
+	{
+		runFindImageBenchmark(stream, benchmarkOptions.repeat);
+
+		return 0;
+	}
+
+	app.addLibraryPath(QApplication::applicationDirPath() + "/actions");
+	app.addLibraryPath(QApplication::applicationDirPath() + "/plugins");
+
+	ActionTools::ActionFactory actionFactory;
+	QSettings settings;
+	QString locale = settings.value("gui/locale", QLocale::system().name()).toString();
+
+	actionFactory.loadActionPacks(QApplication::applicationDirPath() + "/actions/", locale);
+
+	foreach(int actionCount, actionCounts)
+		runBenchmark(stream, actionFactory, actionCount, benchmarkOptions);
+
+	return 0;
+}
@@ -36,11 +36,16 @@
 #include "codeexecution.h"
 #include "codestdio.h"
 
+#ifdef ACT_PROFILE
+#include "highresolutiontimer.h"
+#endif
+
 #include <QScriptEngine>
 #include <QFile>
 #include <QUiLoader>
 #include <QDir>
 #include <QFileInfo>
+#include <QRegExp>
 
 namespace
 {
@@ -109,6 +114,10 @@ namespace LibExecuter
 
     void CodeInitializer::initialize(QScriptEngine *scriptEngine, ScriptAgent *scriptAgent, ActionTools::ActionFactory *actionFactory, const QString &filename)
 	{
+	#ifdef ACT_PROFILE
+		Tools::HighResolutionTimer timer("CodeInitializer::initialize");
+	#endif
+
 		scriptEngine->setProcessEventsInterval(50);
 
 		QScriptValue loadUIFunc = scriptEngine->newFunction(&loadUIFunction);
@@ -117,16 +126,18 @@ namespace LibExecuter
 		QScriptValue includeFunc = scriptEngine->newFunction(&includeFunction);
 		scriptEngine->globalObject().setProperty("include", includeFunc);
 
-		Code::Window::registerClass(scriptEngine);
-		Code::RawData::registerClass(scriptEngine);
-		Code::Image::registerClass(scriptEngine);
-		Code::Algorithms::registerClass(scriptEngine);
-		Code::Color::registerClass(scriptEngine);
-		Code::Point::registerClass(scriptEngine);
-		Code::Size::registerClass(scriptEngine);
-		Code::Rect::registerClass(scriptEngine);
-		Code::ProcessHandle::registerClass(scriptEngine);
-
+		//Classes are only registered when a script first uses them
+		Code::CodeTools::addLazyGlobalToScriptEngine("Window", [](const QString &, QScriptEngine *engine){ Code::Window::registerClass(engine); }, scriptEngine);
+		Code::CodeTools::addLazyGlobalToScriptEngine("RawData", [](const QString &, QScriptEngine *engine){ Code::RawData::registerClass(engine); }, scriptEngine);
+		Code::CodeTools::addLazyGlobalToScriptEngine("Image", [](const QString &, QScriptEngine *engine){ Code::Image::registerClass(engine); }, scriptEngine);
+		Code::CodeTools::addLazyGlobalToScriptEngine("Algorithms", [](const QString &, QScriptEngine *engine){ Code::Algorithms::registerClass(engine); }, scriptEngine);
+		Code::CodeTools::addLazyGlobalToScriptEngine("Color", [](const QString &, QScriptEngine *engine){ Code::Color::registerClass(engine); }, scriptEngine);
+		Code::CodeTools::addLazyGlobalToScriptEngine("Point", [](const QString &, QScriptEngine *engine){ Code::Point::registerClass(engine); }, scriptEngine);
+		Code::CodeTools::addLazyGlobalToScriptEngine("Size", [](const QString &, QScriptEngine *engine){ Code::Size::registerClass(engine); }, scriptEngine);
+		Code::CodeTools::addLazyGlobalToScriptEngine("Rect", [](const QString &, QScriptEngine *engine){ Code::Rect::registerClass(engine); }, scriptEngine);
+		Code::CodeTools::addLazyGlobalToScriptEngine("ProcessHandle", [](const QString &, QScriptEngine *engine){ Code::ProcessHandle::registerClass(engine); }, scriptEngine);
+
+		//Execution is not lazy: it holds the filename used to resolve relative paths
 		CodeExecution::setScriptAgent(scriptAgent);
 		Code::CodeTools::addClassToScriptEngine<CodeExecution>("Execution", scriptEngine);
 		Code::CodeTools::addClassGlobalFunctionToScriptEngine("Execution", &CodeExecution::pause, "pause", scriptEngine);
@@ -136,7 +147,7 @@ namespace LibExecuter
         QScriptValue executionObject = scriptEngine->globalObject().property("Execution");
         executionObject.setProperty("filename", filename, QScriptValue::ReadOnly);
 
-		Code::CodeTools::addClassToScriptEngine<CodeStdio>("Stdio", scriptEngine);
+		Code::CodeTools::addLazyClassToScriptEngine<CodeStdio>("Stdio", scriptEngine);
 		Code::CodeTools::addClassGlobalFunctionToScriptEngine("Stdio", &CodeStdio::print, "print", scriptEngine);
 		Code::CodeTools::addClassGlobalFunctionToScriptEngine("Stdio", &CodeStdio::println, "println", scriptEngine);
 		Code::CodeTools::addClassGlobalFunctionToScriptEngine("Stdio", &CodeStdio::printWarning, "printWarning", scriptEngine);
@@ -152,4 +163,21 @@ namespace LibExecuter
 			actionPack->codeInit(scriptEngine);
 		}
 	}
+
+	void CodeInitializer::importExtensions(QScriptEngine *scriptEngine, const QString &code)
+	{
+	#ifdef ACT_PROFILE
+		Tools::HighResolutionTimer timer("CodeInitializer::importExtensions");
+	#endif
+
+		//The extensions are the Qt bindings, whose classes all start with a Q. Code that is not known in advance (included files,
+		//eval or the Function constructor) could use them too.
+		static const QRegExp extensionUseRegExp("\\bQ(t\\b|[A-Z])|\\b(include|eval|Function)\\s*\\(");
+
+		if(!code.contains(extensionUseRegExp))
+			return;
+
+		for(const QString &extension: scriptEngine->availableExtensions())
+			scriptEngine->importExtension(extension);
+	}
 }
@@ -24,6 +24,7 @@
 #include "executer_global.h"
 
 class QScriptEngine;
+class QString;
 
 namespace ActionTools
 {
@@ -41,6 +42,9 @@ namespace LibExecuter
                                ScriptAgent *scriptAgent,
                                ActionTools::ActionFactory *actionFactory,
                                const QString &filename);
+
+		//Importing the script extensions is slow, so they are only imported if the code can use them
+		static void importExtensions(QScriptEngine *scriptEngine, const QString &code);
 	};
 }
 
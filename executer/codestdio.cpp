@@ -19,6 +19,7 @@
 */
 
 #include "codestdio.h"
+#include "executer.h"
 
 #include <QScriptContext>
 #include <QTextStream>
@@ -81,7 +82,7 @@ namespace LibExecuter
 
 	void CodeStdio::print(const QString &text)
 	{
-		QTextStream stream(stdout);
+		QTextStream &stream = Executer::standardOutput();
 		stream << text;
 		stream.flush();
 	}
@@ -32,6 +32,7 @@
 #include "code/rawdata.h"
 #include "code/prettyprinting.h"
 #include "codeactiona.h"
+#include "executionprofiler.h"
 
 #include <QDesktopWidget>
 #include <QAction>
@@ -41,6 +42,8 @@
 #include <QProgressDialog>
 #include <QScriptEngine>
 #include <QScriptValueIterator>
+#include <QTextStream>
+#include <QFile>
 
 namespace LibExecuter
 {
@@ -54,12 +57,17 @@ namespace LibExecuter
 		mScriptAgent(0),
 		mHasExecuted(false),
         mPauseInterrupt(false),
-        mShowDebuggerOnCodeError(true)
+        mShowDebuggerOnCodeError(true),
+		mReleaseMode(false),
+		mProfiler(0),
+		mExecutionFailed(false),
+		mProcedureCallDepth(0)
 	{
 		connect(mExecutionWindow, SIGNAL(canceled()), this, SLOT(stopExecution()));
 		connect(mExecutionWindow, SIGNAL(paused()), this, SLOT(pauseExecution()));
 		connect(mExecutionWindow, SIGNAL(debug()), this, SLOT(debugExecution()));
-		connect(&mExecutionTimer, SIGNAL(timeout()), this, SLOT(updateTimerProgress()));
+		connect(&mExecutionTimer, SIGNAL(timeout()), this, SLOT(executionTimerTimeout()));
+		connect(&mProgressTimer, SIGNAL(timeout()), this, SLOT(updateTimerProgress()));
 		connect(&mScriptEngineDebugger, SIGNAL(evaluationSuspended()), mExecutionWindow, SLOT(onEvaluationPaused()));
 		connect(&mScriptEngineDebugger, SIGNAL(evaluationResumed()), mExecutionWindow, SLOT(onEvaluationResumed()));
 		connect(&mScriptEngineDebugger, SIGNAL(evaluationSuspended()), this, SLOT(executionPaused()));
@@ -77,8 +85,58 @@ namespace LibExecuter
 	{
 		delete mExecutionWindow;
 		delete mConsoleWidget;
+		delete mProfiler;
+	}
+
+	bool Executer::dumpTrace(const QString &filename) const
+	{
+		if(!mScript)
+			return false;
+
+		return mTrace.write(filename, mScript);
+	}
+
+	void Executer::setProfilingEnabled(bool profilingEnabled)
+	{
+		if(profilingEnabled == (mProfiler != 0))
+			return;
+
+		if(profilingEnabled)
+			mProfiler = new ExecutionProfiler;
+		else
+		{
+			delete mProfiler;
+			mProfiler = 0;
+		}
 	}
 	
+	QString Executer::scriptCode() const
+	{
+		QStringList code;
+
+		for(const ActionTools::ScriptParameter &scriptParameter: mScript->parameters())
+		{
+			if(scriptParameter.isCode())
+				code.append(scriptParameter.value());
+		}
+
+		for(int actionIndex = 0; actionIndex < mScript->actionCount(); ++actionIndex)
+		{
+			const ActionTools::ParametersData &parametersData = mScript->actionAt(actionIndex)->parametersData();
+
+			for(const ActionTools::Parameter &parameter: parametersData)
+			{
+				for(const ActionTools::SubParameter &subParameter: parameter.subParameters())
+				{
+					if(subParameter.isCode())
+						code.append(subParameter.value().toString());
+				}
+			}
+		}
+
+		return code.join(QLatin1Char('\n'));
+	}
+
 	void Executer::setup(ActionTools::Script *script,
 			   ActionTools::ActionFactory *actionFactory,
 			   bool showExecutionWindow,
@@ -92,13 +150,12 @@ namespace LibExecuter
                Tools::Version actionaVersion,
 			   Tools::Version scriptVersion,
 			   bool isActExec,
-			   QStandardItemModel *consoleModel)
+			   ActionTools::ConsoleModel *consoleModel)
 	{
 		mScript = script;
 		mScriptEngine = new QScriptEngine(this);
 
-		for(QString extension: mScriptEngine->availableExtensions())
-			mScriptEngine->importExtension(extension);
+		CodeInitializer::importExtensions(mScriptEngine, scriptCode());
 		
 		mActionFactory = actionFactory;
 		mShowExecutionWindow = showExecutionWindow;
@@ -122,23 +179,42 @@ namespace LibExecuter
 
         Code::setupPrettyPrinting(*mScriptEngine);
 		
-		mScriptEngineDebugger.attachTo(mScriptEngine);
-		mDebuggerWindow = mScriptEngineDebugger.standardWindow();
-
 		mScriptAgent = new ScriptAgent(mScriptEngine);
 
 		connect(mScriptAgent, SIGNAL(executionStopped()), this, SLOT(stopExecution()));
-		connect(mScriptAgent, SIGNAL(evaluationStarted()), mExecutionWindow, SLOT(enableDebug()));
-		connect(mScriptAgent, SIGNAL(evaluationStopped()), mExecutionWindow, SLOT(disableDebug()));
 
-		QScriptEngineAgent *debuggerAgent = mScriptEngine->agent();
-		mScriptEngine->setAgent(mScriptAgent);
-		mScriptAgent->setDebuggerAgent(debuggerAgent);
+		if(mReleaseMode)
+		{
+			//The agent is only used to keep track of the execution context
+			mDebuggerWindow = 0;
+		}
+		else
+		{
+			mScriptEngineDebugger.attachTo(mScriptEngine);
+			mDebuggerWindow = mScriptEngineDebugger.standardWindow();
+
+			connect(mScriptAgent, SIGNAL(evaluationStarted()), mExecutionWindow, SLOT(enableDebug()));
+			connect(mScriptAgent, SIGNAL(evaluationStopped()), mExecutionWindow, SLOT(disableDebug()));
+
+			QScriptEngineAgent *debuggerAgent = mScriptEngine->agent();
+			mScriptEngine->setAgent(mScriptAgent);
+			mScriptAgent->setDebuggerAgent(debuggerAgent);
+		}
 		
 		mConsoleWidget->setup(consoleModel);
 		
-		mExecutionTimer.setSingleShot(false);
-		mExecutionTimer.setInterval(5);
+		mExecutionStepPending = false;
+
+		//The execution timer is a one-shot deadline timer: it is armed with a zero interval when no pause or timeout
+		//is needed, so that the next step runs as soon as control returns to the event loop
+		mExecutionTimer.setSingleShot(true);
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
+		mExecutionTimer.setTimerType(Qt::PreciseTimer);
+#endif
+
+		//Progress updates are only needed when a pause or a timeout is displayed
+		mProgressTimer.setSingleShot(false);
+		mProgressTimer.setInterval(ProgressUpdateInterval);
 		mConsoleWidget->updateClearButton();
 	}
 	
@@ -152,8 +228,6 @@ namespace LibExecuter
 
 	void printCall(QScriptContext *context, ActionTools::ConsoleWidget::Type type)
 	{
-		QApplication::processEvents();//Call this to prevent UI freeze when calling print often
-
 		QScriptValue calleeData = context->callee().data();
 		Executer *executer = qobject_cast<Executer *>(calleeData.toQObject());
 		QString message;
@@ -165,13 +239,19 @@ namespace LibExecuter
 		for(int argumentIndex = 0; argumentIndex < context->argumentCount(); ++argumentIndex)
 			message += context->argument(argumentIndex).toString();
 
+		if(executer->isActExec())
+		{
+			Executer::printToStandardOutput(message, type);
+			return;
+		}
+
 		switch(executer->scriptAgent()->context())
 		{
 		case ScriptAgent::Parameters:
 			executer->consoleWidget()->addScriptParameterLine(message,
 															  agent->currentParameter(),
-															  agent->currentLine(),
-															  agent->currentColumn(),
+															  executer->currentScriptLine(),
+															  executer->currentScriptColumn(),
 															  type);
 			break;
 		case ScriptAgent::Actions:
@@ -183,10 +263,10 @@ namespace LibExecuter
 
 				executer->consoleWidget()->addUserLine(message,
 													   currentActionRuntimeId,
-                                                       context->engine()->globalObject().property("currentParameter").toString(),
-                                                       context->engine()->globalObject().property("currentSubParameter").toString(),
-													   agent->currentLine(),
-													   agent->currentColumn(),
+													   currentAction ? currentAction->currentParameter() : QString(),
+													   currentAction ? currentAction->currentSubParameter() : QString(),
+													   executer->currentScriptLine(),
+													   executer->currentScriptColumn(),
 													   context->backtrace(),
 													   type);
 			}
@@ -268,6 +348,112 @@ namespace LibExecuter
         return engine->undefinedValue();
     }
 
+    //Getter of an image resource global, the image is decoded on first use and kept in the callee data
+    QScriptValue imageResourceFunction(QScriptContext *context, QScriptEngine *engine)
+    {
+        QScriptValue calleeData = context->callee().data();
+        QScriptValue value = calleeData.property("value");
+        if(value.isValid())
+            return value;
+
+        Executer *executer = qobject_cast<Executer *>(calleeData.property("executer").toQObject());
+        QString key = calleeData.property("key").toString();
+        QImage image = executer->script()->resource(key).image();
+
+        if(image.isNull())
+        {
+            executer->consoleWidget()->addResourceLine(QObject::tr("Invalid image resource"), key, ActionTools::ConsoleWidget::Error);
+            Code::CodeClass::throwError(context, engine, "ResourceError", QObject::tr("Invalid image resource %1").arg(key));
+
+            return QScriptValue();
+        }
+
+        value = Code::Image::constructor(image, engine);
+        calleeData.setProperty("value", value);
+
+        return value;
+    }
+
+    //Script.nextLine, Script.doNotResetPreviousActions and Script.line are accessors backed by the Script object,
+    //so that the executer does not have to read them back from the script engine after each action
+    QScriptValue nextLineFunction(QScriptContext *context, QScriptEngine *engine)
+    {
+        Q_UNUSED(engine)
+
+        QScriptValue calleeData = context->callee().data();
+        Executer *executer = qobject_cast<Executer *>(calleeData.toQObject());
+        ActionTools::Script *script = executer->script();
+
+        if(context->argumentCount() > 0)//Setter
+        {
+            script->setNextLine(context->argument(0).toString());
+
+            return context->argument(0);
+        }
+
+        if(script->nextLineIsLabel())
+            return script->nextLineLabel();
+
+        return script->nextLine();
+    }
+
+    QScriptValue doNotResetPreviousActionsFunction(QScriptContext *context, QScriptEngine *engine)
+    {
+        Q_UNUSED(engine)
+
+        QScriptValue calleeData = context->callee().data();
+        Executer *executer = qobject_cast<Executer *>(calleeData.toQObject());
+        ActionTools::Script *script = executer->script();
+
+        if(context->argumentCount() > 0)//Setter
+        {
+            script->setDoNotResetPreviousActions(context->argument(0).toBool());
+
+            return context->argument(0);
+        }
+
+        return script->doNotResetPreviousActions();
+    }
+
+    QScriptValue lineFunction(QScriptContext *context, QScriptEngine *engine)
+    {
+        Q_UNUSED(engine)
+
+        QScriptValue calleeData = context->callee().data();
+        Executer *executer = qobject_cast<Executer *>(calleeData.toQObject());
+
+        return executer->currentActionIndex() + 1;
+    }
+
+    //currentParameter and currentSubParameter are only published to the script engine when read
+    QScriptValue currentParameterFunction(QScriptContext *context, QScriptEngine *engine)
+    {
+        Q_UNUSED(engine)
+
+        QScriptValue calleeData = context->callee().data();
+        Executer *executer = qobject_cast<Executer *>(calleeData.toQObject());
+        ActionTools::ActionInstance *currentActionInstance = executer->currentActionInstance();
+
+        if(!currentActionInstance)
+            return QString();
+
+        return currentActionInstance->currentParameter();
+    }
+
+    QScriptValue currentSubParameterFunction(QScriptContext *context, QScriptEngine *engine)
+    {
+        Q_UNUSED(engine)
+
+        QScriptValue calleeData = context->callee().data();
+        Executer *executer = qobject_cast<Executer *>(calleeData.toQObject());
+        ActionTools::ActionInstance *currentActionInstance = executer->currentActionInstance();
+
+        if(!currentActionInstance)
+            return QString();
+
+        return currentActionInstance->currentSubParameter();
+    }
+
     bool Executer::startExecution(bool onlySelection, const QString &filename)
 	{
 		Q_ASSERT(mScriptAgent);
@@ -292,9 +478,23 @@ namespace LibExecuter
 		
         QScriptValue script = mScriptEngine->newObject();
 		mScriptEngine->globalObject().setProperty("Script", script, QScriptValue::ReadOnly);
-        script.setProperty("nextLine", 1);
-        script.setProperty("doNotResetPreviousActions", false);
-        script.setProperty("line", 1, QScriptValue::ReadOnly);
+        mScript->setNextLine(1);
+        mScript->setDoNotResetPreviousActions(false);
+        QScriptValue accessorFunction = mScriptEngine->newFunction(nextLineFunction);
+        accessorFunction.setData(mScriptEngine->newQObject(this));
+        script.setProperty("nextLine", accessorFunction, QScriptValue::PropertyGetter | QScriptValue::PropertySetter);
+        accessorFunction = mScriptEngine->newFunction(doNotResetPreviousActionsFunction);
+        accessorFunction.setData(mScriptEngine->newQObject(this));
+        script.setProperty("doNotResetPreviousActions", accessorFunction, QScriptValue::PropertyGetter | QScriptValue::PropertySetter);
+        accessorFunction = mScriptEngine->newFunction(lineFunction);
+        accessorFunction.setData(mScriptEngine->newQObject(this));
+        script.setProperty("line", accessorFunction, QScriptValue::PropertyGetter);
+        accessorFunction = mScriptEngine->newFunction(currentParameterFunction);
+        accessorFunction.setData(mScriptEngine->newQObject(this));
+        mScriptEngine->globalObject().setProperty("currentParameter", accessorFunction, QScriptValue::PropertyGetter);
+        accessorFunction = mScriptEngine->newFunction(currentSubParameterFunction);
+        accessorFunction.setData(mScriptEngine->newQObject(this));
+        mScriptEngine->globalObject().setProperty("currentSubParameter", accessorFunction, QScriptValue::PropertyGetter);
         QScriptValue callProcedureFun = mScriptEngine->newFunction(callProcedureFunction);
         callProcedureFun.setData(mScriptEngine->newQObject(this));
         script.setProperty("callProcedure", callProcedureFun);
@@ -322,12 +522,14 @@ namespace LibExecuter
 		mCurrentActionIndex = 0;
 		mActiveActionsCount = 0;
 		mExecutionPaused = false;
+		mExecutionStepPending = false;
 
 		bool initSucceeded = true;
 		int lastBeginProcedure = -1;
 
 		mScript->clearProcedures();
 		mScript->clearCallStack();
+		mScript->clearActionsToReset();
 
         const QHash<QString, ActionTools::Resource> &resources = mScript->resources();
         for(const QString &key: resources.keys())
@@ -346,18 +548,15 @@ namespace LibExecuter
                 break;
             case ActionTools::Resource::ImageType:
                 {
-                    QImage image;
-
-                    if(!image.loadFromData(resource.data()))
-                    {
-                        mConsoleWidget->addResourceLine(tr("Invalid image resource"), key, ActionTools::ConsoleWidget::Error);
-
-                        return false;
-                    }
-
-                    value = Code::Image::constructor(image, mScriptEngine);
+                    //Images are only decoded when used, the decoded image is kept by the script resource
+                    QScriptValue accessorFunction = mScriptEngine->newFunction(imageResourceFunction);
+                    QScriptValue accessorData = mScriptEngine->newObject();
+                    accessorData.setProperty("executer", mScriptEngine->newQObject(this));
+                    accessorData.setProperty("key", key);
+                    accessorFunction.setData(accessorData);
+                    mScriptEngine->globalObject().setProperty(key, accessorFunction, QScriptValue::PropertyGetter | QScriptValue::Undeletable);
                 }
-                break;
+                continue;
             }
 
             mScriptEngine->globalObject().setProperty(key, value, QScriptValue::ReadOnly | QScriptValue::Undeletable);
@@ -533,12 +732,28 @@ namespace LibExecuter
 			mConsoleWidget->show();
 		}
 
+		mScript->compileLabels();
+
 		mExecutionStarted = true;
 
 		mScriptAgent->setContext(ScriptAgent::Actions);
 		
 		mHasExecuted = true;
 
+	#ifdef ACT_PROFILE
+		mExecutedActionsCount = 0;
+		mRunTime.start();
+	#endif
+
+		ActionTools::ActionInstance::setProfilingEnabled(mProfiler != 0);
+		if(mProfiler)
+			mProfiler->clear(mScript->actionCount());
+
+		mExecutionFailed = false;
+		mProcedureCallDepth = mScript->procedureCallDepth();
+		mTrace.start();
+		mTrace.record(ExecutionTrace::ExecutionStarted, mCurrentActionIndex);
+
 		executeCurrentAction();
 
 		return true;
@@ -551,7 +766,8 @@ namespace LibExecuter
 		
 		mScriptAgent->pause(false);
 		mScriptAgent->stopExecution(false);
-		mScriptEngineDebugger.action(QScriptEngineDebugger::ContinueAction)->trigger();
+		if(!mReleaseMode)
+			mScriptEngineDebugger.action(QScriptEngineDebugger::ContinueAction)->trigger();
 		
 		mExecutionStarted = false;
 		mExecutionStatus = Stopped;
@@ -560,18 +776,49 @@ namespace LibExecuter
             mScriptEngine->abortEvaluation();
 
 		mExecutionTimer.stop();
+		mProgressTimer.stop();
+		mExecutionStepPending = false;
 
 		if(mCurrentActionIndex >= 0 && mCurrentActionIndex < mScript->actionCount())
 		{
 			currentActionInstance()->disconnect();
 			if(!mExecutionEnded)
 				currentActionInstance()->stopExecution();
+
+			if(mProfiler)
+				mProfiler->stop(currentActionInstance()->evaluationTime());
 		}
 
+		ActionTools::ActionInstance::setProfilingEnabled(false);
+
+		mTrace.record(ExecutionTrace::ExecutionStopped, mCurrentActionIndex);
+		if(mExecutionFailed && !mTraceDumpFilename.isEmpty() && !dumpTrace(mTraceDumpFilename))
+			consolePrint(tr("Unable to write the execution trace to \"%1\"").arg(mTraceDumpFilename), ActionTools::ConsoleWidget::Warning);
+
 		for(int actionIndex = 0; actionIndex < mScript->actionCount(); ++actionIndex)
-			mScript->actionAt(actionIndex)->stopLongTermExecution();
+		{
+			ActionTools::ActionInstance *actionInstance = mScript->actionAt(actionIndex);
+			actionInstance->stopLongTermExecution();
+			actionInstance->clearExecution();
+		}
+
+		if(!mReleaseMode)
+			mScriptEngineDebugger.detach();
 
-		mScriptEngineDebugger.detach();
+		flushStandardOutput();
+
+	#ifdef ACT_PROFILE
+		{
+			qint64 runTime = mRunTime.elapsed();
+			QTextStream stream(stdout);
+			stream << "Executed " << mExecutedActionsCount << " actions in " << runTime << "ms";
+			if(runTime > 0)
+				stream << " (" << (mExecutedActionsCount * 1000.0) / runTime << " actions/s)";
+			stream << (mReleaseMode ? ", release mode" : "") << "\n";
+		}
+	#endif
+
+		mScript->clearCompiledLabels();
 		
         if(mScriptAgent)
         {
@@ -586,8 +833,10 @@ namespace LibExecuter
 
 		delete mProgressDialog;
 		mProgressDialog = 0;
-		mDebuggerWindow->hide();
+		if(mDebuggerWindow)
+			mDebuggerWindow->hide();
 		mExecutionWindow->hide();
+		mConsoleWidget->flush();
 		mConsoleWidget->hide();
 
 		emit executionStopped();
@@ -610,6 +859,8 @@ namespace LibExecuter
 		bool standardException = (exception >= 0 && exception < ActionTools::ActionException::ExceptionCount);
 		bool customException = false;
 
+		mTrace.record(ExecutionTrace::Exception, mCurrentActionIndex, exception);
+
 		for(ActionTools::ActionException *actionException: actionInstance->definition()->exceptions())
 		{
 			if(actionException->id() == exception)
@@ -624,6 +875,7 @@ namespace LibExecuter
 			mConsoleWidget->addDesignErrorLine(tr("Action design error: Invalid exception emitted (%1, line %2)")
 											   .arg(actionInstance->definition()->name())
 											   .arg(mCurrentActionIndex+1), ActionTools::ConsoleWidget::Error);
+			mExecutionFailed = true;
 			stopExecution();
 			return;
 		}
@@ -658,8 +910,7 @@ namespace LibExecuter
 				}
 				else
 				{
-					QScriptValue script = mScriptEngine->globalObject().property("Script");
-					script.setProperty("nextLine", mScriptEngine->newVariant(QVariant(exceptionActionInstance.line())));
+					mScript->setNextLine(exceptionActionInstance.line());
 					actionExecutionEnded();
 					shouldStopExecution = false;
 				}
@@ -682,12 +933,13 @@ namespace LibExecuter
 
 			mConsoleWidget->addActionLine(finalMessage + message,
 										currentActionRuntimeId,
-                                        mScriptEngine->globalObject().property("currentParameter").toString(),
-                                        mScriptEngine->globalObject().property("currentSubParameter").toString(),
-										mScriptAgent->currentLine(),
-										mScriptAgent->currentColumn(),
+										currentAction ? currentAction->currentParameter() : QString(),
+										currentAction ? currentAction->currentSubParameter() : QString(),
+										currentScriptLine(),
+										currentScriptColumn(),
 										exceptionType);
 
+			mExecutionFailed = true;
 			stopExecution();
 		}
 	}
@@ -697,21 +949,16 @@ namespace LibExecuter
 		mExecutionTimer.stop();
 		currentActionInstance()->disconnect();
 
+		if(mProfiler)
+			mProfiler->endExecution(currentActionInstance()->evaluationTime());
+
+		mTrace.record(ExecutionTrace::ActionEnded, mCurrentActionIndex);
+
 		emit actionEnded(mCurrentActionIndex, mActiveActionsCount);
 		
 		mExecutionStatus = PostPause;
 
-		mExecutionTimer.start();
-		mExecutionTime.start();
-		if(currentActionInstance()->pauseAfter() + mPauseAfter > 0)
-		{
-			mExecutionWindow->setProgressEnabled(true);
-			mExecutionWindow->setProgressMinimum(0);
-			mExecutionWindow->setProgressMaximum(currentActionInstance()->pauseAfter() + mPauseAfter);
-			mExecutionWindow->setProgressValue(0);
-		}
-		else
-			mExecutionWindow->setProgressEnabled(false);
+		startExecutionTimer(currentActionInstance()->pauseAfter() + mPauseAfter);
 		
 		mExecutionEnded = true;
 	}
@@ -725,25 +972,24 @@ namespace LibExecuter
 	{
 		mExecutionEnded = false;
 
-		QScriptValue script = mScriptEngine->globalObject().property("Script");
-		QString nextLineString = script.property("nextLine").toString();
-		int previousLine = mCurrentActionIndex;
+		if(mProfiler)
+			mProfiler->endPostPause();
 
-		bool ok;
-		int nextLine = nextLineString.toInt(&ok);
+		int previousLine = mCurrentActionIndex;
+		int nextLine;
 
-		if(!ok)
+		if(mScript->nextLineIsLabel())
 		{
-			nextLine = mScript->labelLine(nextLineString);
+			nextLine = mScript->labelLine(mScript->nextLineLabel());
 
 			if(nextLine == -1)
 			{
-				executionException(ActionTools::ActionException::CodeErrorException, tr("Unable to find the label named \"%1\"").arg(nextLineString));
+				executionException(ActionTools::ActionException::CodeErrorException, tr("Unable to find the label named \"%1\"").arg(mScript->nextLineLabel()));
 				return;
 			}
 		}
 		else
-			--nextLine;//Make the nextLine value 0-based instead of 1-based
+			nextLine = mScript->nextLine() - 1;//Make the nextLine value 0-based instead of 1-based
 
 		if(nextLine < 0 || nextLine == mScript->actionCount())//End of the script
 			mCurrentActionIndex = nextLine;
@@ -752,10 +998,10 @@ namespace LibExecuter
 			switch(canExecuteAction(nextLine))
 			{
 			case IncorrectLine:
-				executionException(ActionTools::ActionException::CodeErrorException, tr("Incorrect Script.nextLine value: %1").arg(nextLineString));
+				executionException(ActionTools::ActionException::CodeErrorException, tr("Incorrect Script.nextLine value: %1").arg(mScript->nextLineString()));
 				return;
 			case InvalidAction:
-				executionException(ActionTools::ActionException::CodeErrorException, tr("The action at line %1 is invalid").arg(nextLineString));
+				executionException(ActionTools::ActionException::CodeErrorException, tr("The action at line %1 is invalid").arg(mScript->nextLineString()));
 				return;
 			case DisabledAction:
 			case UnselectedAction:
@@ -765,16 +1011,37 @@ namespace LibExecuter
 			}
 		}
 
-        bool doNotResetPreviousActions = script.property("doNotResetPreviousActions").toBool();
+		int procedureCallDepth = mScript->procedureCallDepth();
+		if(procedureCallDepth > mProcedureCallDepth)
+			mTrace.record(ExecutionTrace::ProcedureCall, previousLine, mCurrentActionIndex);
+		else if(procedureCallDepth < mProcedureCallDepth)
+			mTrace.record(ExecutionTrace::ProcedureReturn, previousLine, mCurrentActionIndex);
+		else if(mCurrentActionIndex != previousLine + 1)
+			mTrace.record(ExecutionTrace::Jump, previousLine, mCurrentActionIndex);
+		mProcedureCallDepth = procedureCallDepth;
 
-        if(doNotResetPreviousActions)
+        if(mScript->doNotResetPreviousActions())
         {
-            script.setProperty("doNotResetPreviousActions", false);
+            mScript->setDoNotResetPreviousActions(false);
         }
-        else if(mCurrentActionIndex >= 0)
+        else if(mCurrentActionIndex >= 0 && mCurrentActionIndex < previousLine)
         {
-			for(int actionIndex = mCurrentActionIndex; actionIndex < previousLine; ++actionIndex)
-				mScript->actionAt(actionIndex)->reset();
+		#ifdef ACT_PROFILE
+			QElapsedTimer resetTime;
+			resetTime.start();
+		#endif
+
+			int resetCount = mScript->resetActions(mCurrentActionIndex, previousLine);
+
+		#ifdef ACT_PROFILE
+			{
+				QTextStream stream(stdout);
+				stream << "Executer::resetActions [" << (mCurrentActionIndex + 1) << "-" << previousLine << "]: reset "
+					   << resetCount << " actions in " << (resetTime.nsecsElapsed() / 1000) << "us\n";
+			}
+		#else
+			Q_UNUSED(resetCount)
+		#endif
         }
 
 		executeCurrentAction();
@@ -788,63 +1055,71 @@ namespace LibExecuter
 
 		int actionTimeout = currentActionInstance()->timeout();
 		if(actionTimeout > 0)
-		{
-			mExecutionTimer.start();
-			mExecutionTime.start();
-			mExecutionWindow->setProgressEnabled(true);
-			mExecutionWindow->setProgressMinimum(0);
-			mExecutionWindow->setProgressMaximum(actionTimeout);
-			mExecutionWindow->setProgressValue(0);
-		}
+			startExecutionTimer(actionTimeout);
 		else
+		{
+			mProgressTimer.stop();
 			mExecutionWindow->setProgressEnabled(false);
+		}
 
 		emit actionStarted(mCurrentActionIndex, mActiveActionsCount);
 
+	#ifdef ACT_PROFILE
+		++mExecutedActionsCount;
+	#endif
+
+		if(mProfiler)
+		{
+			currentActionInstance()->clearEvaluationTime();
+			mProfiler->startExecution();
+		}
+
+		mTrace.record(ExecutionTrace::ActionStarted, mCurrentActionIndex);
+
 		currentActionInstance()->startExecution();
 	}
 
-	void Executer::updateTimerProgress()
+	void Executer::executionTimerTimeout()
 	{
 		if(mExecutionPaused)
+		{
+			//Run this step again when the execution is resumed
+			mExecutionStepPending = true;
 			return;
-		
+		}
+
 		ActionTools::ActionInstance *actionInstance = currentActionInstance();
 		switch(mExecutionStatus)
 		{
 		case PrePause:
-			if(mExecutionTime.elapsed() >= actionInstance->pauseBefore() + mPauseBefore)
-			{
-				mExecutionTimer.stop();
-				startActionExecution();
-			}
-			mExecutionWindow->setProgressValue(mExecutionTime.elapsed());
+			mProgressTimer.stop();
+			startActionExecution();
 			break;
 		case Executing://Timeout
-			if(mExecutionTime.elapsed() >= actionInstance->timeout())
-			{
-				mExecutionTimer.stop();
-				actionInstance->disconnect();
-				actionInstance->stopExecution();
-	
-				executionException(ActionTools::ActionException::TimeoutException, QString());
-			}
-			mExecutionWindow->setProgressValue(mExecutionTime.elapsed());
+			mProgressTimer.stop();
+			actionInstance->disconnect();
+			actionInstance->stopExecution();
+
+			executionException(ActionTools::ActionException::TimeoutException, QString());
 			break;
 		case PostPause:
-			if(mExecutionTime.elapsed() >= actionInstance->pauseAfter() + mPauseAfter)
-			{
-				mExecutionTimer.stop();
-				startNextAction();
-			}
-			mExecutionWindow->setProgressValue(mExecutionTime.elapsed());
+			mProgressTimer.stop();
+			startNextAction();
 			break;
 		default:
-			Q_ASSERT(false && "updateTimerProgress() called, but execution is stopped");
+			Q_ASSERT(false && "executionTimerTimeout() called, but execution is stopped");
 			break;
 		}
 	}
 
+	void Executer::updateTimerProgress()
+	{
+		if(mExecutionPaused)
+			return;
+
+		mExecutionWindow->setProgressValue(mExecutionTime.elapsed());
+	}
+
 	void Executer::showProgressDialog(const QString &title, int maximum)
 	{
 		if(!mProgressDialog)
@@ -893,6 +1168,8 @@ namespace LibExecuter
 	void Executer::executionResumed()
 	{
 		mExecutionPaused = false;
+
+		resumePendingExecutionStep();
 	}
 
 	void Executer::consolePrint(const QString &text)
@@ -925,6 +1202,12 @@ namespace LibExecuter
 
 	void Executer::consolePrint(const QString &text, ActionTools::ConsoleWidget::Type type)
 	{
+		if(mIsActExec)
+		{
+			printToStandardOutput(text, type);
+			return;
+		}
+
 		ActionTools::ActionInstance *currentAction = mScript->actionAt(currentActionIndex());
 		qint64 currentActionRuntimeId = -1;
 		if(currentAction)
@@ -932,14 +1215,76 @@ namespace LibExecuter
 
 		consoleWidget()->addUserLine(text,
 									   currentActionRuntimeId,
-                                       mScriptEngine->globalObject().property("currentParameter").toString(),
-                                       mScriptEngine->globalObject().property("currentSubParameter").toString(),
-									   mScriptAgent->currentLine(),
-									   mScriptAgent->currentColumn(),
+									   currentAction ? currentAction->currentParameter() : QString(),
+									   currentAction ? currentAction->currentSubParameter() : QString(),
+									   currentScriptLine(),
+									   currentScriptColumn(),
 									   mScriptEngine->currentContext()->backtrace(),
 									   type);
 	}
 
+	void Executer::printToStandardOutput(const QString &text, ActionTools::ConsoleWidget::Type type)
+	{
+		QTextStream &stream = standardOutput();
+
+		switch(type)
+		{
+		case ActionTools::ConsoleWidget::Warning:
+			stream << tr("Warning: %1").arg(text) << "\n";
+			break;
+		case ActionTools::ConsoleWidget::Error:
+			stream << tr("Error: %1").arg(text) << "\n";
+			break;
+		default:
+			stream << text << "\n";
+			break;
+		}
+
+		//Each line is shown as soon as it is printed, long executions and daemon jobs included
+		stream.flush();
+	}
+
+	void Executer::flushStandardOutput()
+	{
+		standardOutput().flush();
+	}
+
+	namespace
+	{
+		//Kept between lines so that printing does not create a stream each time
+		struct StandardOutput
+		{
+			StandardOutput()
+			{
+				file.open(stdout, QIODevice::WriteOnly);
+				stream.setDevice(&file);
+			}
+
+			QFile file;
+			QTextStream stream;
+		};
+
+		StandardOutput &standardOutputInstance()
+		{
+			static StandardOutput standardOutput;
+
+			return standardOutput;
+		}
+	}
+
+	QTextStream &Executer::standardOutput()
+	{
+		return standardOutputInstance().stream;
+	}
+
+	void Executer::setStandardOutput(QIODevice *device)
+	{
+		StandardOutput &standardOutput = standardOutputInstance();
+
+		standardOutput.stream.flush();
+		standardOutput.stream.setDevice(device ? device : &standardOutput.file);
+	}
+
 	void Executer::pauseOrDebug(bool debug)
 	{
 		if(mExecutionStatus == Stopped)
@@ -949,7 +1294,7 @@ namespace LibExecuter
 
 		mPauseInterrupt = !debug;
 
-		if(mScriptEngine->isEvaluating())
+		if(mScriptEngine->isEvaluating() && !mReleaseMode)
 		{
 			if(mExecutionPaused)
 			{
@@ -981,6 +1326,60 @@ namespace LibExecuter
 		}
 
 		mExecutionWindow->setPauseStatus(mExecutionPaused);
+
+		if(!mExecutionPaused)
+			resumePendingExecutionStep();
+	}
+
+	int Executer::currentScriptLine() const
+	{
+		if(!mReleaseMode)
+			return mScriptAgent->currentLine();
+
+		//Without the agent, only the line of the last uncaught exception is known
+		if(mScriptEngine && mScriptEngine->hasUncaughtException())
+			return mScriptEngine->uncaughtExceptionLineNumber();
+
+		return -1;
+	}
+
+	int Executer::currentScriptColumn() const
+	{
+		if(!mReleaseMode)
+			return mScriptAgent->currentColumn();
+
+		return -1;
+	}
+
+	void Executer::startExecutionTimer(int duration)
+	{
+		mExecutionTime.start();
+
+		if(duration > 0)
+		{
+			mExecutionWindow->setProgressEnabled(true);
+			mExecutionWindow->setProgressMinimum(0);
+			mExecutionWindow->setProgressMaximum(duration);
+			mExecutionWindow->setProgressValue(0);
+
+			mProgressTimer.start();
+		}
+		else
+		{
+			mProgressTimer.stop();
+			mExecutionWindow->setProgressEnabled(false);
+		}
+
+		mExecutionTimer.start(qMax(duration, 0));
+	}
+
+	void Executer::resumePendingExecutionStep()
+	{
+		if(!mExecutionStepPending || mExecutionStatus == Stopped)
+			return;
+
+		mExecutionStepPending = false;
+		mExecutionTimer.start(0);
 	}
 
 	Executer::ExecuteActionResult Executer::canExecuteAction(int index) const
@@ -1020,9 +1419,7 @@ namespace LibExecuter
 		if(nextLine > mScript->actionCount())
 			nextLine = -1;
 
-		QScriptValue script = mScriptEngine->globalObject().property("Script");
-		script.setProperty("nextLine", mScriptEngine->newVariant(QVariant(nextLine)));
-        script.setProperty("line", mCurrentActionIndex + 1, QScriptValue::ReadOnly);
+		mScript->setNextLine(nextLine);
 
 		ActionTools::ActionInstance *actionInstance = currentActionInstance();
 
@@ -1046,17 +1443,10 @@ namespace LibExecuter
 		
 		mExecutionStatus = PrePause;
 
-		mExecutionTimer.start();
-		mExecutionTime.start();
-		if(currentActionInstance()->pauseBefore() + mPauseBefore > 0)
-		{
-			mExecutionWindow->setProgressEnabled(true);
-			mExecutionWindow->setProgressMinimum(0);
-			mExecutionWindow->setProgressMaximum(currentActionInstance()->pauseBefore() + mPauseBefore);
-			mExecutionWindow->setProgressValue(0);
-		}
-		else
-			mExecutionWindow->setProgressEnabled(false);
+		if(mProfiler)
+			mProfiler->startPrePause(mCurrentActionIndex);
+
+		startExecutionTimer(currentActionInstance()->pauseBefore() + mPauseBefore);
 
 		mExecutionEnded = true;
 	}
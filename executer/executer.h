@@ -23,6 +23,7 @@
 
 #include "executer_global.h"
 #include "consolewidget.h"
+#include "executiontrace.h"
 #include "version.h"
 
 #include <QObject>
@@ -35,17 +36,20 @@ namespace ActionTools
 	class Script;
 	class ActionFactory;
 	class ActionInstance;
+	class ConsoleModel;
 }
 
-class QStandardItemModel;
 class QMainWindow;
 class QScriptEngine;
 class QProgressDialog;
+class QTextStream;
+class QIODevice;
 
 namespace LibExecuter
 {
 	class ExecutionWindow;
 	class ScriptAgent;
+	class ExecutionProfiler;
 
 	class EXECUTERSHARED_EXPORT Executer : public QObject
 	{
@@ -68,18 +72,43 @@ namespace LibExecuter
                    Tools::Version actionaVersion,
 				   Tools::Version scriptVersion,
 				   bool isActExec,
-				   QStandardItemModel *consoleModel);
+				   ActionTools::ConsoleModel *consoleModel);
+
+		//In release mode the script debugger is not attached and the script agent is not installed,
+		//so that no callback is made for each script statement
+		void setReleaseMode(bool releaseMode)				{ mReleaseMode = releaseMode; }
+		bool isReleaseMode() const							{ return mReleaseMode; }
+
+		//When enabled, per-action timings are collected and kept until the next execution
+		void setProfilingEnabled(bool profilingEnabled);
+		ExecutionProfiler *profiler() const					{ return mProfiler; }
+
+		//The last execution events are kept in a ring buffer, dumped to this file if the execution stops on an error
+		void setTraceDumpFilename(const QString &filename)	{ mTraceDumpFilename = filename; }
+		const ExecutionTrace &trace() const					{ return mTrace; }
+		bool dumpTrace(const QString &filename) const;
+		bool hasExecutionFailed() const						{ return mExecutionFailed; }
 
 		ExecutionWindow *executionWindow() const			{ return mExecutionWindow; }
 		ActionTools::ConsoleWidget *consoleWidget() const	{ return mConsoleWidget; }
 		ScriptAgent *scriptAgent() const					{ return mScriptAgent; }
 
 		int currentActionIndex() const						{ return mCurrentActionIndex; }
+		bool isActExec() const								{ return mIsActExec; }
+
+		//Used instead of the console widget when running in actexec
+		static void printToStandardOutput(const QString &text, ActionTools::ConsoleWidget::Type type);
+		static void flushStandardOutput();
+		//Stream used instead of stdout, to print the messages of an execution; setStandardOutput(0) goes back to stdout
+		static QTextStream &standardOutput();
+		static void setStandardOutput(QIODevice *device);
 		ActionTools::Script *script() const					{ return mScript; }
 		
 		static bool isExecuterRunning()						{ return (mExecutionStatus != Stopped); }
 
         ActionTools::ActionInstance *currentActionInstance() const;
+		int currentScriptLine() const;
+		int currentScriptColumn() const;
 
 	public slots:
         bool startExecution(bool onlySelection, const QString &filename);
@@ -100,6 +129,7 @@ namespace LibExecuter
 		void disableAction(bool disable);
 		void startNextAction();
 		void startActionExecution();
+		void executionTimerTimeout();
 		void updateTimerProgress();
 		void showProgressDialog(const QString &title, int maximum);
 		void updateProgressDialog(const QString &caption);
@@ -133,6 +163,11 @@ namespace LibExecuter
 		ExecuteActionResult canExecuteAction(const QString &line) const;
 		ExecuteActionResult canExecuteAction(int index) const;
 		void executeCurrentAction();
+		void startExecutionTimer(int duration);
+		void resumePendingExecutionStep();
+		QString scriptCode() const;
+
+		static const int ProgressUpdateInterval = 50;
 
 		ActionTools::Script *mScript;
 		ActionTools::ActionFactory *mActionFactory;
@@ -154,7 +189,9 @@ namespace LibExecuter
 		ScriptAgent *mScriptAgent;
 		QList<bool> mActionEnabled;
 		QTimer mExecutionTimer;
+		QTimer mProgressTimer;
 		QElapsedTimer mExecutionTime;
+		bool mExecutionStepPending;
 		QProgressDialog *mProgressDialog;
 		int mActiveActionsCount;
 		bool mExecutionPaused;
@@ -167,6 +204,16 @@ namespace LibExecuter
 		Tools::Version mScriptVersion;
 		bool mIsActExec;
         bool mShowDebuggerOnCodeError;
+		bool mReleaseMode;
+		ExecutionProfiler *mProfiler;
+		ExecutionTrace mTrace;
+		QString mTraceDumpFilename;
+		bool mExecutionFailed;
+		int mProcedureCallDepth;
+#ifdef ACT_PROFILE
+		QElapsedTimer mRunTime;
+		int mExecutedActionsCount;
+#endif
 
 		Q_DISABLE_COPY(Executer)
 	};
@@ -22,7 +22,9 @@ SOURCES += executer.cpp \
     codeexecution.cpp \
 	codestdio.cpp \
     scriptagent.cpp \
-    codeactiona.cpp
+    codeactiona.cpp \
+    executionprofiler.cpp \
+    executiontrace.cpp
 HEADERS += executer_global.h \
 	executer.h \
 	executionwindow.h \
@@ -30,7 +32,9 @@ HEADERS += executer_global.h \
     codeinitializer.h \
     codeexecution.h \
 	codestdio.h \
-    codeactiona.h
+    codeactiona.h \
+    executionprofiler.h \
+    executiontrace.h
 INCLUDEPATH += src \
 	../tools \
 	../actiontools
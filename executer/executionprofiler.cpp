@@ -0,0 +1,263 @@
+/*
+	Actiona
+	Copyright (C) 2005-2017 Jonathan Mercier-Ganady
+
+	Actiona is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Actiona is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+	Contact : jmgr@jmgr.info
+*/
+
+#include "executionprofiler.h"
+#include "script.h"
+#include "actioninstance.h"
+#include "actiondefinition.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+
+#include <algorithm>
+#include <limits>
+
+namespace LibExecuter
+{
+	namespace
+	{
+		double toMilliseconds(qint64 nanoseconds)
+		{
+			return nanoseconds / 1000000.0;
+		}
+
+		QString csvField(QString value)
+		{
+			if(!value.contains(QLatin1Char(',')) && !value.contains(QLatin1Char('"')) && !value.contains(QLatin1Char('\n')))
+				return value;
+
+			value.replace(QLatin1Char('"'), QStringLiteral("\"\""));
+
+			return QLatin1Char('"') + value + QLatin1Char('"');
+		}
+	}
+
+	ExecutionProfiler::ActionStatistics::ActionStatistics()
+		: callCount(0),
+		  totalTime(0),
+		  minTime(std::numeric_limits<qint64>::max()),
+		  maxTime(0),
+		  evaluationTime(0),
+		  prePauseTime(0),
+		  postPauseTime(0)
+	{
+	}
+
+	ExecutionProfiler::ExecutionProfiler()
+		: mPhase(Idle),
+		  mCurrentLine(-1)
+	{
+	}
+
+	void ExecutionProfiler::clear(int actionCount)
+	{
+		mStatistics.clear();
+		mStatistics.resize(actionCount);
+		mPhase = Idle;
+		mCurrentLine = -1;
+	}
+
+	void ExecutionProfiler::startPrePause(int line)
+	{
+		if(line < 0 || line >= mStatistics.size())
+			return;
+
+		mCurrentLine = line;
+		mPhase = PrePause;
+		mPhaseTime.start();
+	}
+
+	void ExecutionProfiler::startExecution()
+	{
+		if(mPhase != PrePause)
+			return;
+
+		mStatistics[mCurrentLine].prePauseTime += mPhaseTime.nsecsElapsed();
+		mPhase = Executing;
+		mPhaseTime.start();
+	}
+
+	void ExecutionProfiler::endExecution(qint64 evaluationTime)
+	{
+		if(mPhase != Executing)
+			return;
+
+		addExecution(mStatistics[mCurrentLine], mPhaseTime.nsecsElapsed(), evaluationTime);
+		mPhase = PostPause;
+		mPhaseTime.start();
+	}
+
+	void ExecutionProfiler::endPostPause()
+	{
+		if(mPhase != PostPause)
+			return;
+
+		mStatistics[mCurrentLine].postPauseTime += mPhaseTime.nsecsElapsed();
+		mPhase = Idle;
+	}
+
+	void ExecutionProfiler::stop(qint64 evaluationTime)
+	{
+		switch(mPhase)
+		{
+		case PrePause:
+			mStatistics[mCurrentLine].prePauseTime += mPhaseTime.nsecsElapsed();
+			break;
+		case Executing:
+			addExecution(mStatistics[mCurrentLine], mPhaseTime.nsecsElapsed(), evaluationTime);
+			break;
+		case PostPause:
+			mStatistics[mCurrentLine].postPauseTime += mPhaseTime.nsecsElapsed();
+			break;
+		default:
+			break;
+		}
+
+		mPhase = Idle;
+	}
+
+	bool ExecutionProfiler::write(const QString &filename, const ActionTools::Script *script) const
+	{
+		QFile file(filename);
+		if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+			return false;
+
+		if(filename.endsWith(QStringLiteral(".csv"), Qt::CaseInsensitive))
+			writeCsv(&file, script);
+		else
+			writeJson(&file, script);
+
+		return true;
+	}
+
+	void ExecutionProfiler::writeJson(QIODevice *device, const ActionTools::Script *script) const
+	{
+		QJsonArray actions;
+
+		for(int line: sortedLines())
+		{
+			const ActionStatistics &statistics = mStatistics.at(line);
+			const ActionTools::ActionInstance *actionInstance = script->actionAt(line);
+			QJsonObject action;
+
+			action.insert(QStringLiteral("line"), line + 1);
+			action.insert(QStringLiteral("action"), actionInstance ? actionInstance->definition()->id() : QString());
+			action.insert(QStringLiteral("label"), actionInstance ? actionInstance->label() : QString());
+			action.insert(QStringLiteral("calls"), statistics.callCount);
+			action.insert(QStringLiteral("totalMs"), toMilliseconds(statistics.totalTime));
+			action.insert(QStringLiteral("minMs"), toMilliseconds(statistics.callCount > 0 ? statistics.minTime : 0));
+			action.insert(QStringLiteral("maxMs"), toMilliseconds(statistics.maxTime));
+			action.insert(QStringLiteral("meanMs"), toMilliseconds(statistics.callCount > 0 ? statistics.totalTime / statistics.callCount : 0));
+			action.insert(QStringLiteral("p95Ms"), toMilliseconds(percentile(statistics.samples, 95)));
+			action.insert(QStringLiteral("evaluationMs"), toMilliseconds(statistics.evaluationTime));
+			action.insert(QStringLiteral("nativeMs"), toMilliseconds(statistics.totalTime - statistics.evaluationTime));
+			action.insert(QStringLiteral("prePauseMs"), toMilliseconds(statistics.prePauseTime));
+			action.insert(QStringLiteral("postPauseMs"), toMilliseconds(statistics.postPauseTime));
+
+			actions.append(action);
+		}
+
+		QJsonObject root;
+		root.insert(QStringLiteral("actions"), actions);
+
+		device->write(QJsonDocument(root).toJson());
+	}
+
+	void ExecutionProfiler::writeCsv(QIODevice *device, const ActionTools::Script *script) const
+	{
+		QTextStream stream(device);
+
+		stream << "line,action,label,calls,totalMs,minMs,maxMs,meanMs,p95Ms,evaluationMs,nativeMs,prePauseMs,postPauseMs\n";
+
+		for(int line: sortedLines())
+		{
+			const ActionStatistics &statistics = mStatistics.at(line);
+			const ActionTools::ActionInstance *actionInstance = script->actionAt(line);
+
+			stream << line + 1 << ','
+				   << csvField(actionInstance ? actionInstance->definition()->id() : QString()) << ','
+				   << csvField(actionInstance ? actionInstance->label() : QString()) << ','
+				   << statistics.callCount << ','
+				   << toMilliseconds(statistics.totalTime) << ','
+				   << toMilliseconds(statistics.callCount > 0 ? statistics.minTime : 0) << ','
+				   << toMilliseconds(statistics.maxTime) << ','
+				   << toMilliseconds(statistics.callCount > 0 ? statistics.totalTime / statistics.callCount : 0) << ','
+				   << toMilliseconds(percentile(statistics.samples, 95)) << ','
+				   << toMilliseconds(statistics.evaluationTime) << ','
+				   << toMilliseconds(statistics.totalTime - statistics.evaluationTime) << ','
+				   << toMilliseconds(statistics.prePauseTime) << ','
+				   << toMilliseconds(statistics.postPauseTime) << '\n';
+		}
+	}
+
+	void ExecutionProfiler::addExecution(ActionStatistics &statistics, qint64 time, qint64 evaluationTime)
+	{
+		++statistics.callCount;
+		statistics.totalTime += time;
+		statistics.minTime = qMin(statistics.minTime, time);
+		statistics.maxTime = qMax(statistics.maxTime, time);
+		statistics.evaluationTime += qMin(evaluationTime, time);
+
+		//Reservoir sampling: every call has the same probability to be kept
+		if(statistics.samples.size() < MaxSampleCount)
+			statistics.samples.append(time);
+		else
+		{
+			quint32 random = (static_cast<quint32>(qrand()) << 16) ^ static_cast<quint32>(qrand());
+			int index = static_cast<int>(random % static_cast<quint32>(statistics.callCount));
+			if(index < MaxSampleCount)
+				statistics.samples[index] = time;
+		}
+	}
+
+	QList<int> ExecutionProfiler::sortedLines() const
+	{
+		QList<int> lines;
+
+		for(int line = 0; line < mStatistics.size(); ++line)
+		{
+			const ActionStatistics &statistics = mStatistics.at(line);
+			if(statistics.callCount > 0 || statistics.prePauseTime > 0 || statistics.postPauseTime > 0)
+				lines.append(line);
+		}
+
+		//Slowest lines first
+		std::stable_sort(lines.begin(), lines.end(), [this](int first, int second)
+		{
+			return mStatistics.at(first).totalTime > mStatistics.at(second).totalTime;
+		});
+
+		return lines;
+	}
+
+	qint64 ExecutionProfiler::percentile(QVector<qint64> samples, int percent)
+	{
+		if(samples.isEmpty())
+			return 0;
+
+		int index = qMin((samples.size() * percent + 99) / 100, samples.size()) - 1;
+		std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+
+		return samples.at(index);
+	}
+}
@@ -0,0 +1,98 @@
+/*
+	Actiona
+	Copyright (C) 2005-2017 Jonathan Mercier-Ganady
+
+	Actiona is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Actiona is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+	Contact : jmgr@jmgr.info
+*/
+
+#ifndef EXECUTIONPROFILER_H
+#define EXECUTIONPROFILER_H
+
+#include "executer_global.h"
+
+#include <QVector>
+#include <QList>
+#include <QElapsedTimer>
+
+class QIODevice;
+
+namespace ActionTools
+{
+	class Script;
+}
+
+namespace LibExecuter
+{
+	//Collects per-action timings during an execution
+	class EXECUTERSHARED_EXPORT ExecutionProfiler
+	{
+	public:
+		ExecutionProfiler();
+
+		void clear(int actionCount);
+
+		//Called by the executer at each step of an action's execution
+		void startPrePause(int line);
+		void startExecution();
+		void endExecution(qint64 evaluationTime);
+		void endPostPause();
+		void stop(qint64 evaluationTime);//evaluationTime is only used if an action is being executed
+
+		//The format is CSV if the filename ends with .csv, JSON otherwise
+		bool write(const QString &filename, const ActionTools::Script *script) const;
+		void writeJson(QIODevice *device, const ActionTools::Script *script) const;
+		void writeCsv(QIODevice *device, const ActionTools::Script *script) const;
+
+	private:
+		enum Phase
+		{
+			Idle,
+			PrePause,
+			Executing,
+			PostPause
+		};
+
+		//All durations are in nanoseconds
+		struct ActionStatistics
+		{
+			ActionStatistics();
+
+			int callCount;
+			qint64 totalTime;
+			qint64 minTime;
+			qint64 maxTime;
+			qint64 evaluationTime;
+			qint64 prePauseTime;
+			qint64 postPauseTime;
+			QVector<qint64> samples;//Reservoir used to estimate the percentiles
+		};
+
+		void addExecution(ActionStatistics &statistics, qint64 time, qint64 evaluationTime);
+		QList<int> sortedLines() const;
+		static qint64 percentile(QVector<qint64> samples, int percent);
+
+		static const int MaxSampleCount = 1024;
+
+		QVector<ActionStatistics> mStatistics;
+		QElapsedTimer mPhaseTime;
+		Phase mPhase;
+		int mCurrentLine;
+
+		Q_DISABLE_COPY(ExecutionProfiler)
+	};
+}
+
+#endif // EXECUTIONPROFILER_H
@@ -0,0 +1,184 @@
+/*
+	Actiona
+	Copyright (C) 2005-2017 Jonathan Mercier-Ganady
+
+	Actiona is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Actiona is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+	Contact : jmgr@jmgr.info
+*/
+
+#include "executiontrace.h"
+#include "script.h"
+#include "actioninstance.h"
+#include "actiondefinition.h"
+#include "actionexception.h"
+
+#include <QFile>
+#include <QDataStream>
+#include <QTextStream>
+#include <QStringList>
+#include <QDateTime>
+
+namespace LibExecuter
+{
+	ExecutionTrace::ExecutionTrace()
+		: mPosition(0),
+		  mWrapped(false),
+		  mStartDateTime(0)
+	{
+	}
+
+	void ExecutionTrace::start()
+	{
+		mPosition.storeRelease(0);
+		mWrapped = false;
+		mStartDateTime = QDateTime::currentMSecsSinceEpoch();
+		mTime.start();
+	}
+
+	QVector<ExecutionTrace::Event> ExecutionTrace::events() const
+	{
+		int position = mPosition.loadAcquire();
+		QVector<Event> result;
+
+		if(mWrapped)
+		{
+			result.reserve(Capacity);
+			for(int index = position; index < Capacity; ++index)
+				result.append(mEvents[index]);
+		}
+		else
+			result.reserve(position);
+
+		for(int index = 0; index < position; ++index)
+			result.append(mEvents[index]);
+
+		return result;
+	}
+
+	bool ExecutionTrace::write(const QString &filename, const ActionTools::Script *script) const
+	{
+		QFile file(filename);
+		if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+			return false;
+
+		write(&file, script);
+
+		return true;
+	}
+
+	void ExecutionTrace::write(QIODevice *device, const ActionTools::Script *script) const
+	{
+		QDataStream stream(device);
+		stream.setVersion(QDataStream::Qt_5_2);
+
+		//Action names are stored so that the dump can be decoded without the script
+		QStringList actions;
+		for(int line = 0; line < script->actionCount(); ++line)
+		{
+			const ActionTools::ActionInstance *actionInstance = script->actionAt(line);
+			actions.append(actionInstance ? actionInstance->definition()->id() : QString());
+		}
+
+		QVector<Event> recordedEvents = events();
+
+		stream << Magic << FormatVersion << mStartDateTime << actions << static_cast<quint32>(recordedEvents.size());
+
+		for(const Event &event: recordedEvents)
+			stream << event.timestamp << event.type << event.line << event.argument;
+	}
+
+	bool ExecutionTrace::decode(QIODevice *device, QTextStream &output)
+	{
+		QDataStream stream(device);
+		stream.setVersion(QDataStream::Qt_5_2);
+
+		quint32 magic;
+		quint32 formatVersion;
+		qint64 startDateTime;
+		QStringList actions;
+		quint32 eventCount;
+
+		stream >> magic >> formatVersion;
+		if(stream.status() != QDataStream::Ok || magic != Magic || formatVersion != FormatVersion)
+			return false;
+
+		stream >> startDateTime >> actions >> eventCount;
+		if(stream.status() != QDataStream::Ok)
+			return false;
+
+		output << QObject::tr("Execution started at %1, %2 events").arg(QDateTime::fromMSecsSinceEpoch(startDateTime).toString(Qt::ISODate)).arg(eventCount) << "\n";
+
+		auto lineName = [&actions](int line)
+		{
+			if(line >= 0 && line < actions.size())
+				return QObject::tr("line %1 (%2)").arg(line + 1).arg(actions.at(line));
+
+			return QObject::tr("the end of the script");
+		};
+
+		for(quint32 eventIndex = 0; eventIndex < eventCount; ++eventIndex)
+		{
+			Event event;
+
+			stream >> event.timestamp >> event.type >> event.line >> event.argument;
+			if(stream.status() != QDataStream::Ok)
+				return false;
+
+			QString description;
+			switch(event.type)
+			{
+			case ExecutionStarted:
+				description = QObject::tr("execution started");
+				break;
+			case ExecutionStopped:
+				description = QObject::tr("execution stopped at %1").arg(lineName(event.line));
+				break;
+			case ActionStarted:
+				description = QObject::tr("%1 started").arg(lineName(event.line));
+				break;
+			case ActionEnded:
+				description = QObject::tr("%1 ended").arg(lineName(event.line));
+				break;
+			case Jump:
+				description = QObject::tr("%1 jumps to %2").arg(lineName(event.line)).arg(lineName(event.argument));
+				break;
+			case ProcedureCall:
+				description = QObject::tr("%1 calls the procedure at %2").arg(lineName(event.line)).arg(lineName(event.argument));
+				break;
+			case ProcedureReturn:
+				description = QObject::tr("%1 returns to %2").arg(lineName(event.line)).arg(lineName(event.argument));
+				break;
+			case Exception:
+				{
+					QString exceptionName;
+					if(event.argument >= 0 && event.argument < ActionTools::ActionException::ExceptionCount)
+						exceptionName = ActionTools::ActionException::ExceptionName[event.argument];
+					if(exceptionName.isEmpty())
+						exceptionName = QString::number(event.argument);
+
+					description = QObject::tr("%1 raised exception %2").arg(lineName(event.line)).arg(exceptionName);
+				}
+				break;
+			default:
+				description = QObject::tr("unknown event %1 at %2").arg(event.type).arg(lineName(event.line));
+				break;
+			}
+
+			output << QString("%1 ms").arg(event.timestamp / 1000000.0, 14, 'f', 3) << "  " << description << "\n";
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,110 @@
+/*
+	Actiona
+	Copyright (C) 2005-2017 Jonathan Mercier-Ganady
+
+	Actiona is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Actiona is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+	Contact : jmgr@jmgr.info
+*/
+
+#ifndef EXECUTIONTRACE_H
+#define EXECUTIONTRACE_H
+
+#include "executer_global.h"
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QVector>
+
+class QIODevice;
+class QTextStream;
+
+namespace ActionTools
+{
+	class Script;
+}
+
+namespace LibExecuter
+{
+	//Fixed-size ring buffer of the last execution events, dumped for post-mortem analysis.
+	//Events are only recorded by the executer's thread, recording does not allocate nor lock.
+	class EXECUTERSHARED_EXPORT ExecutionTrace
+	{
+	public:
+		enum EventType
+		{
+			ExecutionStarted,
+			ExecutionStopped,
+			ActionStarted,
+			ActionEnded,
+			Jump,//argument is the destination line
+			ProcedureCall,//argument is the destination line
+			ProcedureReturn,//argument is the destination line
+			Exception//argument is the exception id
+		};
+
+		struct Event
+		{
+			qint64 timestamp;//Nanoseconds since the execution start
+			qint32 type;
+			qint32 line;
+			qint32 argument;
+		};
+
+		static const int Capacity = 4096;//Must be a power of two
+
+		ExecutionTrace();
+
+		void start();
+
+		void record(EventType type, int line, int argument = 0)
+		{
+			int position = mPosition.load();
+			Event &event = mEvents[position];
+
+			event.timestamp = mTime.nsecsElapsed();
+			event.type = type;
+			event.line = line;
+			event.argument = argument;
+
+			if(position == Capacity - 1)
+				mWrapped = true;
+
+			mPosition.storeRelease((position + 1) & (Capacity - 1));
+		}
+
+		//Recorded events, oldest first
+		QVector<Event> events() const;
+
+		bool write(const QString &filename, const ActionTools::Script *script) const;
+		void write(QIODevice *device, const ActionTools::Script *script) const;
+
+		//Writes a dump as a readable timeline, returns false if the dump is invalid
+		static bool decode(QIODevice *device, QTextStream &output);
+
+	private:
+		static const quint32 Magic = 0x41435454;//ACTT
+		static const quint32 FormatVersion = 1;
+
+		Event mEvents[Capacity];
+		QAtomicInt mPosition;
+		bool mWrapped;
+		QElapsedTimer mTime;
+		qint64 mStartDateTime;//Milliseconds since epoch
+
+		Q_DISABLE_COPY(ExecutionTrace)
+	};
+}
+
+#endif // EXECUTIONTRACE_H
@@ -58,12 +58,26 @@ namespace LibExecuter
 	{
 		if(mDebuggerAgent)
 			mDebuggerAgent->functionEntry(scriptId);
+
+		//Also called when an evaluation starts, including for programs that are already loaded
+		if(mEvaluationLevel == 0)
+			emit evaluationStarted();
+
+		++mEvaluationLevel;
 	}
 
 	void ScriptAgent::functionExit(qint64 scriptId, const QScriptValue &returnValue)
 	{
 		if(mDebuggerAgent)
 			mDebuggerAgent->functionExit(scriptId, returnValue);
+
+		if(mEvaluationLevel == 0)
+			return;
+
+		--mEvaluationLevel;
+
+		if(mEvaluationLevel == 0)
+			emit evaluationStopped();
 	}
 
 	void ScriptAgent::positionChange(qint64 scriptId, int lineNumber, int columnNumber)
@@ -71,6 +85,7 @@ namespace LibExecuter
 		if(mDebuggerAgent)
 			mDebuggerAgent->positionChange(scriptId, lineNumber, columnNumber);
 
+		mCurrentScriptId = scriptId;
 		mCurrentLine = lineNumber;
 		mCurrentColumn = columnNumber;
 	}
@@ -80,12 +95,8 @@ namespace LibExecuter
 		if(mDebuggerAgent)
 			mDebuggerAgent->scriptLoad(id, program, fileName, baseLineNumber);
 
-		if(mEngineLevel == 0)
-			emit evaluationStarted();
-
-		mFiles.append(program);
-
-		++mEngineLevel;
+		//Compiled programs stay loaded between evaluations, so scripts are tracked by id rather than by load order
+		mScripts.insert(id, program);
 	}
 
 	void ScriptAgent::scriptUnload(qint64 id)
@@ -93,12 +104,7 @@ namespace LibExecuter
 		if(mDebuggerAgent)
 			mDebuggerAgent->scriptUnload(id);
 
-		--mEngineLevel;
-
-		mFiles.pop_back();
-
-		if(mEngineLevel == 0)
-			emit evaluationStopped();
+		mScripts.remove(id);
 	}
 
 	bool ScriptAgent::supportsExtension(Extension extension) const
@@ -24,7 +24,8 @@
 #include "executer_global.h"
 
 #include <QScriptEngineAgent>
-#include <QStringList>
+#include <QHash>
+#include <QString>
 
 namespace LibExecuter
 {
@@ -50,7 +51,8 @@ namespace LibExecuter
 			mPaused(false),
 			mContinueExecution(true),
 			mDebuggerAgent(0),
-			mEngineLevel(0)
+			mCurrentScriptId(-1),
+			mEvaluationLevel(0)
 																			{}
 	
 		void setContext(Context context)									{ mContext = context; }
@@ -62,7 +64,7 @@ namespace LibExecuter
 		int currentColumn() const											{ return mCurrentColumn; }
 		Context context() const												{ return mContext; }
 		int currentParameter() const										{ return mCurrentParameter; }
-		QString currentFile() const											{ return mFiles.count() > 0 ? mFiles.back() : QString(); }
+		QString currentFile() const											{ return mScripts.value(mCurrentScriptId); }
 
 	signals:
 		void executionStopped();
@@ -86,12 +88,13 @@ namespace LibExecuter
 		int mCurrentParameter;
 		int mCurrentLine;
 		int mCurrentColumn;
-		QStringList mFiles;
 		Context mContext;
 		bool mPaused;
 		bool mContinueExecution;
 		QScriptEngineAgent *mDebuggerAgent;
-		int mEngineLevel;
+		QHash<qint64, QString> mScripts;//Loaded scripts, keyed by id
+		qint64 mCurrentScriptId;
+		int mEvaluationLevel;
 	};
 }
 
@@ -35,6 +35,7 @@
 #include "scriptparametersdialog.h"
 #include "crossplatform.h"
 #include "executer.h"
+#include "consolemodel.h"
 #include "newactiondialog.h"
 #include "scriptcontentdialog.h"
 #include "keywords.h"
@@ -144,6 +145,7 @@ MainWindow::MainWindow(QxtCommandOptions *commandOptions, ProgressSplashScreen *
 		ui->reportBugPushButton->setVisible(false);
 	
 	ui->consoleWidget->setup();
+	ui->consoleWidget->model()->setCapacity(QSettings().value("gui/consoleCapacity", ActionTools::ConsoleModel::DefaultCapacity).toInt());
 
 #ifdef Q_OS_WIN
 	HRESULT result = CoCreateInstance(CLSID_TaskbarList, 0, CLSCTX_INPROC_SERVER, IID_ITaskbarList3, reinterpret_cast<LPVOID*>(&mTaskbarList));
@@ -330,7 +332,8 @@ void MainWindow::postInit()
 		{
 			it.next();
 			
-			if(!it.value().isQMetaObject())
+			//Lazy classes are created when first read, their accessor is enough to know that they exist
+			if(!(it.flags() & QScriptValue::PropertyGetter) && !it.value().isQMetaObject())
 				continue;
 
 			mCompletionModel->appendRow(new QStandardItem(QIcon(":/icons/class.png"), it.name()));
@@ -1100,7 +1103,11 @@ void MainWindow::on_actionExport_script_content_triggered()
 	QBuffer buffer;
 	buffer.open(QIODevice::WriteOnly);
 
+    //The content is shown as text, resources have to be inside it
+    ActionTools::Script::ResourceStorage resourceStorage = mScript->resourceStorage();
+    mScript->setResourceStorage(ActionTools::Script::InlineResources);
     writeScript(&buffer);
+    mScript->setResourceStorage(resourceStorage);
 
     ScriptContentDialog scriptContentDialog(ScriptContentDialog::Read, mScript, this);
     scriptContentDialog.setWindowFlags(scriptContentDialog.windowFlags() | Qt::WindowContextHelpButtonHint);
@@ -1437,23 +1444,19 @@ void MainWindow::checkForUpdate(bool silent)
 
 void MainWindow::logItemClicked(int itemRow, bool doubleClick)
 {
-	QStandardItemModel *model = qobject_cast<QStandardItemModel *>(ui->consoleWidget->model());
-	if(!model)
+	const QModelIndex &item = ui->consoleWidget->model()->index(itemRow, 0);
+	if(!item.isValid())
 		return;
 
-	QStandardItem *item = model->item(itemRow, 0);
-	if(!item)
-		return;
-
-	switch(item->data(ActionTools::ConsoleWidget::SourceRole).value<ActionTools::ConsoleWidget::Source>())
+	switch(item.data(ActionTools::ConsoleWidget::SourceRole).value<ActionTools::ConsoleWidget::Source>())
 	{
 	case ActionTools::ConsoleWidget::Parameters:
 		{
 			if(doubleClick)
 			{
-				int parameter = item->data(ActionTools::ConsoleWidget::ParameterRole).toInt();
-				int line = item->data(ActionTools::ConsoleWidget::LineRole).toInt();
-				int column = item->data(ActionTools::ConsoleWidget::ColumnRole).toInt();
+				int parameter = item.data(ActionTools::ConsoleWidget::ParameterRole).toInt();
+				int line = item.data(ActionTools::ConsoleWidget::LineRole).toInt();
+				int column = item.data(ActionTools::ConsoleWidget::ColumnRole).toInt();
 				openParametersDialog(parameter, line, column);
 			}
 		}
@@ -1462,7 +1465,7 @@ void MainWindow::logItemClicked(int itemRow, bool doubleClick)
         {
             if(doubleClick)
             {
-                const QString &resource = item->data(ActionTools::ConsoleWidget::ResourceRole).toString();
+                const QString &resource = item.data(ActionTools::ConsoleWidget::ResourceRole).toString();
                 openResourceDialog(resource);
             }
         }
@@ -1470,17 +1473,17 @@ void MainWindow::logItemClicked(int itemRow, bool doubleClick)
 	case ActionTools::ConsoleWidget::Action:
 	case ActionTools::ConsoleWidget::User:
 		{
-			qint64 actionRuntimeId = item->data(ActionTools::ConsoleWidget::ActionRole).toLongLong();
+			qint64 actionRuntimeId = item.data(ActionTools::ConsoleWidget::ActionRole).toLongLong();
 			int action = mScript->actionIndexFromRuntimeId(actionRuntimeId);
 			if(action == -1)
 				break;
 
 			if(doubleClick)
 			{
-				QString field = item->data(ActionTools::ConsoleWidget::FieldRole).toString();
-				QString subField = item->data(ActionTools::ConsoleWidget::SubFieldRole).toString();
-				int line = item->data(ActionTools::ConsoleWidget::LineRole).toInt();
-				int column = item->data(ActionTools::ConsoleWidget::ColumnRole).toInt();
+				QString field = item.data(ActionTools::ConsoleWidget::FieldRole).toString();
+				QString subField = item.data(ActionTools::ConsoleWidget::SubFieldRole).toString();
+				int line = item.data(ActionTools::ConsoleWidget::LineRole).toInt();
+				int column = item.data(ActionTools::ConsoleWidget::ColumnRole).toInt();
 				editAction(mScript->actionAt(action), field, subField, line, column);
 			}
 			else
@@ -1492,14 +1495,14 @@ void MainWindow::logItemClicked(int itemRow, bool doubleClick)
 		break;
 	case ActionTools::ConsoleWidget::Exception:
 		{
-			qint64 actionRuntimeId = item->data(ActionTools::ConsoleWidget::ActionRole).toLongLong();
+			qint64 actionRuntimeId = item.data(ActionTools::ConsoleWidget::ActionRole).toLongLong();
 			int action = mScript->actionIndexFromRuntimeId(actionRuntimeId);
 			if(action == -1)
 				break;
 
 			if(doubleClick)
 			{
-				int exception = item->data(ActionTools::ConsoleWidget::ExceptionRole).toInt();
+				int exception = item.data(ActionTools::ConsoleWidget::ExceptionRole).toInt();
 				editAction(mScript->actionAt(action), exception);
 			}
 			else
@@ -2156,6 +2159,12 @@ bool MainWindow::saveFile(const QString &fileName, bool copy)
 #ifdef ACT_PROFILE
 	Tools::HighResolutionTimer timer(QString("save file %1").arg(fileName));
 #endif
+	//Unused resources can still be read from the file that is going to be overwritten
+	mScript->loadResources();
+
+	QSettings settings;
+	mScript->setResourceStorage(settings.value("gui/appendResources", false).toBool() ? ActionTools::Script::AppendedResources : ActionTools::Script::InlineResources);
+
 	QFile saveFile(fileName);
 	if(!saveFile.open(QIODevice::WriteOnly))
 	{
@@ -2170,8 +2179,6 @@ bool MainWindow::saveFile(const QString &fileName, bool copy)
 			setCurrentFile(fileName);
 		statusBar()->showMessage(tr("File saved"), 2000);
 
-		QSettings settings;
-
         settings.setValue("gui/lastScript", fileName);
 	}
 
@@ -90,6 +90,7 @@ SettingsDialog::SettingsDialog(QSystemTrayIcon *systemTrayIcon, QWidget *parent)
 	ui->addStartEndSeparators->setChecked(settings.value("gui/addConsoleStartEndSeparators", QVariant(true)).toBool());
 	ui->reopenLastScript->setChecked(settings.value("gui/reopenLastScript", QVariant(false)).toBool());
 	ui->maxRecentFiles->setValue(settings.value("gui/maxRecentFiles", QVariant(5)).toInt());
+	ui->appendResources->setChecked(settings.value("gui/appendResources", QVariant(false)).toBool());
 
 	//ACTIONS
 	ui->executionWindowGroup->setChecked(settings.value("actions/showExecutionWindow", QVariant(true)).toBool());
@@ -267,6 +268,7 @@ void SettingsDialog::accept()
 	settings.setValue("gui/addConsoleStartEndSeparators", ui->addStartEndSeparators->isChecked());
 	settings.setValue("gui/reopenLastScript", ui->reopenLastScript->isChecked());
 	settings.setValue("gui/maxRecentFiles", ui->maxRecentFiles->value());
+	settings.setValue("gui/appendResources", ui->appendResources->isChecked());
 
 	//ACTIONS
 	settings.setValue("actions/showExecutionWindow", ui->executionWindowGroup->isChecked());